@@ -38,6 +38,18 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+// Without contraction into FMA, as qNoiseMulti.cpp, so that its lanes round
+// as the steps here. Set before the headers so that the kernels of
+// qNoiseCore.h inlined here are compiled without it too.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC optimize("fp-contract=off")
+#elif defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#endif
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
 #include "qNoise.h"
 
 // #define UNIT_TEST
@@ -45,30 +57,183 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "unit_tests.cpp"
 #endif
 
+// Parameters with all the derived constants.
+qNoiseParams::qNoiseParams(double tau, double q, double H)
+    : tau(tau), q(q), H(H) {
+  sqrt_H = sqrt(H);
+  invTau = 1 / tau;
+  tauQm1 = tau * (q - 1);
+  etaCut = 1 / sqrt(tau * (1 - q));
+  decay = exp(-H / tau);
+  diffusion = sqrt((1 - exp(-2 / tau * H)) / 2 / tau);
+  driftH = H * invTau;
+  noiseH = sqrt_H * invTau;
+  if (q < 1)
+    regime = QNOISE_BOUNDED;
+  else if (q == 1)
+    regime = QNOISE_GAUSSIAN;
+  else
+    regime = QNOISE_UNBOUNDED;
+}
+
+qNoiseParams qNoiseParams::norm(double tau, double q, double H) {
+  return qNoiseParams(tau * (5 - 3 * q) / 2, q, H);
+}
+
+void qNoiseSchedule::add(size_t step, double tau, double q, double H) {
+  knot k = {step, tau, q, H};
+  std::vector<knot>::iterator it = knots.begin();
+  while (it != knots.end() && it->step < step)
+    ++it;
+  if (it != knots.end() && it->step == step)
+    *it = k;
+  else
+    knots.insert(it, k);
+}
+
+qNoiseParams qNoiseSchedule::piece(size_t step, size_t &end) const {
+  // First knot after step
+  size_t i = 0;
+  while (i < knots.size() && knots[i].step <= step)
+    i++;
+  end = i < knots.size() ? knots[i].step : size_t(-1);
+  if (i == 0 || i == knots.size() || interpolation == SCHEDULE_CONSTANT) {
+    const knot &k = knots[i == 0 ? 0 : i - 1];
+    return qNoiseParams(k.tau, k.q, k.H);
+  }
+  // Pieces of resolution steps from the previous knot, so that they do not
+  // depend on how the series is split in chunks.
+  const knot &a = knots[i - 1], &b = knots[i];
+  size_t begin = a.step + (step - a.step) / resolution * resolution;
+  end = std::min(end, begin + resolution);
+  double w = ((begin + end - 1) / 2.0 - a.step) / (b.step - a.step);
+  return qNoiseParams(a.tau + w * (b.tau - a.tau), a.q + w * (b.q - a.q),
+                      a.H + w * (b.H - a.H));
+}
+
 // Manual seeding.
-void qNoiseGen::seedManual(unsigned UserSeed) {
+template <class Engine>
+void qNoiseGenT<Engine>::seedManual(unsigned UserSeed) {
   seed = UserSeed;
+  stream = 0;
   generator.seed(seed);
+  randNorm.reset();
+  fastGenerator.seed(seed);
+  gaussPos = gaussBuffer.size();
 }
 
 // Timer seeding
-// Note: when using this on multiple threads, call seedManual on each thread
-// using different values of seed
+// Note: when using this on multiple threads, call seedStream on each thread
+// with the same seed and different streams, or use qNoisePool
 
-void qNoiseGen::seedTimer() {
+template <class Engine>
+void qNoiseGenT<Engine>::seedTimer() {
   // obtain a seed from the timer
   myclock::duration d = myclock::now() - beginning;
   seed = d.count();
+  stream = -1;
   generator.seed(seed);
+  randNorm.reset();
+  fastGenerator.seed(seed);
+  gaussPos = gaussBuffer.size();
+}
+
+// Seeding of non-overlapping streams
+template <class Engine>
+void qNoiseGenT<Engine>::seedStream(unsigned UserSeed, unsigned stream) {
+  xoshiro256pp engine(UserSeed);
+  for (unsigned k = 0; k < stream; k++)
+    engine.jump();
+  setGaussBackend(GAUSS_ZIGGURAT);
+  seedEngine(UserSeed, engine);
+  this->stream = stream;
+  // The engine of the std backend too, in case it is selected afterwards: as
+  // seedManual for stream 0 and from the stream otherwise.
+  xoshiro256pp first = engine;
+  generator.seed(stream == 0 ? UserSeed : first());
+  randNorm.reset();
+}
+
+// Private. Sets the state of xoshiro256++ directly.
+template <class Engine>
+void qNoiseGenT<Engine>::seedEngine(unsigned UserSeed,
+                                    const xoshiro256pp &engine) {
+  seed = UserSeed;
+  stream = -1;
+  // The engine of the std backend is not drawn from with the Ziggurat one
+  if (gaussBuffer.empty()) {
+    generator.seed(seed);
+    randNorm.reset();
+  }
+  fastGenerator = engine;
+  gaussPos = gaussBuffer.size();
+}
+
+// Skip Gaussian variates of the active backend
+template <class Engine>
+void qNoiseGenT<Engine>::discard(unsigned long long z) {
+  if (gaussBuffer.empty()) {
+    randNorm.discard(generator, z);
+    return;
+  }
+  for (; z > 0; z--)
+    nextGauss();
+}
+
+// Save and restore the state of the generator
+template <class Engine>
+void qNoiseGenT<Engine>::saveState(std::ostream &os) const {
+  std::streamsize precision = os.precision(17);
+  os << seed << ' ' << generator << ' ';
+  randNorm.save(os);
+  os << ' ' << fastGenerator << ' ' << gaussBuffer.size() << ' ' << gaussPos;
+  for (size_t i = gaussPos; i < gaussBuffer.size(); i++)
+    os << ' ' << gaussBuffer[i];
+  os << '\n';
+  os.precision(precision);
+}
+
+template <class Engine>
+bool qNoiseGenT<Engine>::loadState(std::istream &is) {
+  size_t size;
+  is >> seed >> generator;
+  randNorm.load(is);
+  is >> fastGenerator >> size >> gaussPos;
+  if (!is || gaussPos > size)
+    return false;
+  gaussBuffer.assign(size, 0.0);
+  for (size_t i = gaussPos; i < size; i++)
+    is >> gaussBuffer[i];
+  return bool(is);
+}
+
+// Choose the source of Gaussian variates.
+template <class Engine>
+void qNoiseGenT<Engine>::setGaussBackend(gaussBackend backend) {
+  if (backend == GAUSS_ZIGGURAT)
+    gaussBuffer.resize(256);
+  else
+    std::vector<double>().swap(gaussBuffer);
+  gaussPos = gaussBuffer.size();
+}
+
+// Fill the block of Gaussian variates of the Ziggurat backend.
+template <class Engine>
+void qNoiseGenT<Engine>::refillGauss() {
+  ziggurat.fill(fastGenerator, gaussBuffer.data(), gaussBuffer.size());
+  gaussPos = 0;
 }
 
 // Gaussian White noise
-double qNoiseGen::gaussWN() { return randNorm(generator); }
+template <class Engine> double qNoiseGenT<Engine>::gaussWN() {
+  return nextGauss();
+}
 
 // Ornstein-Uhlembeck noise type.
-double qNoiseGen::orsUhl(double eta, double tau, double H) {
+template <class Engine>
+double qNoiseGenT<Engine>::orsUhl(double eta, double tau, double H) {
   return eta * exp(-H / tau) +
-         sqrt((1 - exp(-2 / tau * H)) / 2 / tau) * randNorm(generator);
+         sqrt((1 - exp(-2 / tau * H)) / 2 / tau) * nextGauss();
 }
 
 /*
@@ -78,35 +243,62 @@ double qNoiseGen::orsUhl(double eta, double tau, double H) {
  * \text{tau}}{\text{sigma}^2}+1\right)}{2 (q-1) \text{tau}} it's derivative is:
  * \frac{\text{eta}}{\frac{\text{eta}^2 (q-1) \text{tau}}{\text{sigma}^2}+1}
  * The /tau is the tau present in the differential equation.
+ * It receives 1/tau and tau*(q-1) already computed, as they are constant for a
+ * given set of parameters.
  */
-double qNoiseGen::potQNoisePrime(double eta, double tau, double q) {
-  return (eta / (1 + (eta * eta * tau * (q - 1)))) / tau;
+template <class Engine>
+double qNoiseGenT<Engine>::potQNoisePrime(double eta, double invTau,
+                                          double tauQm1) {
+  return eta / (1 + eta * eta * tauQm1) * invTau;
 }
 
 /*qNoise.
  * This functions integrates a differential equation using the Heun Method
- * for q=1 it behaves like the orstein Uhlembeck noise
+ * for q=1 it is the orstein Uhlembeck noise, which is updated exactly
  * for q<1 it it is defined in a acotated support only (+/- etaCut)
  * for q>1 its statistics are more than gaussian tending (supra-gaussian)
  */
-double qNoiseGen::qNoise(double eta, double tau, double q, double H,
-                         double sqrt_H = -1) {
-  double kHeun, lHeun, differential;
-  bool error = false;
-  int countError = 0;
+template <class Engine>
+double qNoiseGenT<Engine>::qNoise(double eta, double tau, double q, double H,
+                                  double sqrt_H) {
+  if (q == 1) {
+    QNOISE_COUNT(stats.attempts[0]++);
+    return orsUhl(eta, tau, H);
+  }
   // If the square root of H is provided, it will be used, otherwise
   // calculate it every time the function is invoked.
   if (sqrt_H < 0)
     sqrt_H = sqrt(H);
+  if (q > 1)
+    return unboundedStep(eta, H / tau, sqrt_H / tau, tau * (q - 1));
   // The cut value.
   double etaCut = 1 / sqrt(tau * (1 - q));
+  if (q < 1 && bounded == BOUNDED_IMPLICIT)
+    return boundedStep(eta, H / tau, sqrt_H / tau, tau * (q - 1), etaCut);
+  return heunStep(eta, tau, H, sqrt_H, 1 / tau, tau * (q - 1), etaCut);
+}
+
+/*
+ * One Heun step of qNoise for q<1. Private function used by the single sample
+ * and the batch versions of qNoise. The constants that only depend on the
+ * parameters (1/tau, tau*(q-1) and etaCut) are computed by the caller. countError is the
+ * number of attempts already rejected for this step, used by qNoiseMulti to
+ * continue the retries of a path that fell out of bounds.
+ */
+template <class Engine>
+double qNoiseGenT<Engine>::heunStep(double eta, double tau, double H,
+                                    double sqrt_H, double invTau,
+                                    double tauQm1, double etaCut,
+                                    int countError) {
+  double drift, kHeun, lHeun, differential;
+  bool error = false;
   while (1) {
-    kHeun = H * potQNoisePrime(eta, tau, q);
-    lHeun = sqrt_H * randNorm(generator) / tau;
-    differential = -H / 2 *
-                       (potQNoisePrime(eta, tau, q) +
-                        potQNoisePrime(eta + kHeun + lHeun, tau, q)) +
-                   lHeun;
+    drift = potQNoisePrime(eta, invTau, tauQm1);
+    kHeun = H * drift;
+    lHeun = sqrt_H * nextGauss() * invTau;
+    differential =
+        -H / 2 * (drift + potQNoisePrime(eta + kHeun + lHeun, invTau, tauQm1)) +
+        lHeun;
     /*
      * Check if the system is inside the boundary.
      * This is only important when q<1.
@@ -117,25 +309,32 @@ double qNoiseGen::qNoise(double eta, double tau, double q, double H,
      * error is on place to debug these errors. However it should be a concern
      * only for very low values of q and very high values of tau.
      */
-    if ((fabs(eta + differential) > etaCut) || isnan(eta + differential)) {
+    if ((fabs(eta + differential) > etaCut) || std::isnan(eta + differential)) {
       countError++;
+      QNOISE_COUNT(stats.wastedDraws++);
       if (countError > 20) {
+        QNOISE_COUNT(stats.resets++);
+        QNOISE_COUNT(stats.attempts[21]++);
         if (error)
           std::cerr << "Out of bounds phase 3: " << eta << "\t" << differential
                     << std::endl;
-        return eta/fabs(eta) * etaCut * (0.9 + 0.1 * uniform(generator) );
+        return eta/fabs(eta) * etaCut * (0.9 + 0.1 * nextUniform() );
       }
       if (countError > 10) {
+        QNOISE_COUNT(stats.retries[1]++);
+        QNOISE_COUNT(stats.wastedDraws++);
         eta = etaCut * orsUhl(eta, tau, H);
         if (error)
           std::cerr << "Out of bounds phase 2: " << eta << "\t" << differential
                     << std::endl;
       } else {
+        QNOISE_COUNT(stats.retries[0]++);
         if (error)
           std::cerr << "Out of bounds: " << eta << "\t" << differential
                     << std::endl;
       }
     } else {
+      QNOISE_COUNT(stats.attempts[countError]++);
       return eta + differential;
     }
   }
@@ -146,7 +345,239 @@ double qNoiseGen::qNoise(double eta, double tau, double q, double H,
  * noise are independent of q to first order. This approximation fails for q ->
  * 5/3, where both variables diverge.
  */
-double qNoiseGen::qNoiseNorm(double eta, double tau, double q, double H,
-                             double sqrt_H = -1) {
+template <class Engine>
+double qNoiseGenT<Engine>::qNoiseNorm(double eta, double tau, double q,
+                                      double H, double sqrt_H) {
   return qNoise(eta, tau * (5 - 3 * q) / 2, q, H, sqrt_H);
-}
\ No newline at end of file
+}
+
+/*
+ * Generalized Box-Muller method (Thistleton et al., IEEE Trans. Inf. Theory
+ * 53, 2007): with u1, u2 uniform, sqrt(-2 ln_b(u1)) cos(2 pi u2), where
+ * ln_b(u) = (u^(1-b) - 1)/(1-b) and b = (1+q)/(3-q), has the PDF
+ * (1 - (1-q)/(3-q) z^2)^(1/(1-q)). Scaled by 1/sqrt(tau (3-q)) it is the
+ * stationary PDF of qNoise; for q=1 it is the Box-Muller method. For q<1 the
+ * value is inside (-etaCut, etaCut) since u1 > 0.
+ */
+template <class Engine>
+double qNoiseGenT<Engine>::qNoiseStationary(double tau, double q) {
+  // The PDF cannot be normalized, there is nothing to draw from
+  if (!(q < 3))
+    return std::numeric_limits<double>::quiet_NaN();
+  double u1 = 1 - nextUniform(), u2 = nextUniform();
+  double b = (1 + q) / (3 - q);
+  double lnb = b == 1 ? log(u1) : (pow(u1, 1 - b) - 1) / (1 - b);
+  return sqrt(-2 * lnb) * cos(2 * M_PI * u2) / sqrt(tau * (3 - q));
+}
+
+template <class Engine>
+double qNoiseGenT<Engine>::qNoiseStart(const qNoiseParams &p) {
+  if (p.q < 3)
+    return qNoiseStationary(p);
+  double eta = gaussWN() / 100;
+  std::vector<double> buffer(1 << 16);
+  long int transient = 2 * p.tau / p.H;
+  for (long int i = 0; i < transient; i += buffer.size())
+    eta = qNoise(buffer.data(),
+                 std::min<long int>(buffer.size(), transient - i), eta, p);
+  return eta;
+}
+
+// Loop of the batch versions over the kernel k, see step.
+template <class Engine>
+template <int k>
+double qNoiseGenT<Engine>::integrate(double *out, size_t n, double eta,
+                                     const qNoiseParams &p) {
+  // The exact update takes its Gaussian draws in one block
+  if (k == STEP_EXACT)
+    return orsUhl(out, n, eta, p);
+  for (size_t i = 0; i < n; i++) {
+    eta = step<k>(eta, p);
+    out[i] = eta;
+  }
+  return eta;
+}
+
+/*
+ * Batch versions.
+ * They produce the same series as calling the single sample functions in a
+ * loop, but every constant that depends only on the parameters is computed
+ * once per call and the state is kept in a local variable. The last sample is
+ * returned so that a long series can be generated in consecutive chunks.
+ */
+template <class Engine>
+void qNoiseGenT<Engine>::gaussWN(double *out, size_t n) {
+  if (gaussBuffer.empty()) {
+    for (size_t i = 0; i < n; i++)
+      out[i] = randNorm(generator);
+    return;
+  }
+  // Use up the block already drawn and fill the rest directly.
+  size_t i = 0;
+  for (; i < n && gaussPos < gaussBuffer.size(); i++)
+    out[i] = gaussBuffer[gaussPos++];
+  ziggurat.fill(fastGenerator, out + i, n - i);
+}
+
+template <class Engine>
+double qNoiseGenT<Engine>::orsUhl(double *out, size_t n, double eta,
+                                  double tau, double H) {
+  return orsUhl(out, n, eta, qNoiseParams(tau, 1, H));
+}
+
+template <class Engine>
+double qNoiseGenT<Engine>::qNoise(double *out, size_t n, double eta,
+                                  double tau, double q, double H) {
+  return qNoise(out, n, eta, qNoiseParams(tau, q, H));
+}
+
+template <class Engine>
+double qNoiseGenT<Engine>::qNoiseNorm(double *out, size_t n, double eta,
+                                      double tau, double q, double H) {
+  return qNoise(out, n, eta, qNoiseParams::norm(tau, q, H));
+}
+
+template <class Engine>
+double qNoiseGenT<Engine>::orsUhl(double *out, size_t n, double eta,
+                                  const qNoiseParams &p) {
+  // The Gaussian draws are taken in one block and then integrated in place.
+  gaussWN(out, n);
+  double decay = p.decay, diffusion = p.diffusion;
+  for (size_t i = 0; i < n; i++) {
+    eta = eta * decay + diffusion * out[i];
+    out[i] = eta;
+  }
+  return eta;
+}
+
+template <class Engine>
+double qNoiseGenT<Engine>::qNoise(double *out, size_t n, double eta,
+                                  const qNoiseParams &p) {
+  switch (kernel(p)) {
+  case STEP_EXACT:
+    QNOISE_COUNT(stats.attempts[0] += n);
+    return integrate<STEP_EXACT>(out, n, eta, p);
+  case STEP_UNBOUNDED:
+    return integrate<STEP_UNBOUNDED>(out, n, eta, p);
+  case STEP_IMPLICIT:
+    return integrate<STEP_IMPLICIT>(out, n, eta, p);
+  default:
+    return integrate<STEP_RETRY>(out, n, eta, p);
+  }
+}
+
+/*
+ * Float32 versions. The Gaussian draws of a block are taken in double and
+ * then the block is integrated in float with the kernels of qNoiseCore.h.
+ * With the retry scheme, a step out of bounds is retried in double as in
+ * qNoiseMulti, counting the attempt already done, and rounded back inside
+ * the support.
+ */
+template <class Engine>
+void qNoiseGenT<Engine>::gaussWN(float *out, size_t n) {
+  double block[256];
+  for (size_t i = 0; i < n; i += 256) {
+    size_t size = std::min<size_t>(256, n - i);
+    gaussWN(block, size);
+    for (size_t j = 0; j < size; j++)
+      out[i + j] = float(block[j]);
+  }
+}
+
+template <class Engine>
+float qNoiseGenT<Engine>::orsUhl(float *out, size_t n, float eta,
+                                 const qNoiseParams &p) {
+  return integrate<STEP_EXACT>(out, n, eta, p);
+}
+
+template <class Engine>
+float qNoiseGenT<Engine>::qNoise(float *out, size_t n, float eta,
+                                 const qNoiseParams &p) {
+  switch (kernel(p)) {
+  case STEP_EXACT:
+    QNOISE_COUNT(stats.attempts[0] += n);
+    return integrate<STEP_EXACT>(out, n, eta, p);
+  case STEP_UNBOUNDED:
+    return integrate<STEP_UNBOUNDED>(out, n, eta, p);
+  case STEP_IMPLICIT:
+    return integrate<STEP_IMPLICIT>(out, n, eta, p);
+  default:
+    return integrate<STEP_RETRY>(out, n, eta, p);
+  }
+}
+
+template <class Engine>
+template <int k>
+float qNoiseGenT<Engine>::integrate(float *out, size_t n, float eta,
+                                    const qNoiseParams &p) {
+  float driftH = p.driftH, noiseH = p.noiseH, tauQm1 = p.tauQm1;
+  float decay = p.decay, diffusion = p.diffusion, etaCut = p.etaCut;
+  // Largest float strictly inside the support
+  float inside = std::nextafter(etaCut, 0.0f);
+  double block[256];
+  for (size_t i = 0; i < n; i += 256) {
+    size_t size = std::min<size_t>(256, n - i);
+    gaussWN(block, size);
+    for (size_t j = 0; j < size; j++) {
+      float g = block[j];
+      if (k == STEP_EXACT)
+        eta = qnoise::exact(eta, g, decay, diffusion);
+      else if (k == STEP_UNBOUNDED)
+        eta = qnoise::heun(eta, g, driftH, noiseH, tauQm1);
+      else if (k == STEP_IMPLICIT)
+        eta = qnoise::implicit(eta, g, driftH, noiseH, tauQm1, etaCut);
+      else {
+        float next = qnoise::heun(eta, g, driftH, noiseH, tauQm1);
+        if (fabs(next) < etaCut) {
+          QNOISE_COUNT(stats.attempts[0]++);
+          eta = next;
+        } else {
+          float retried = retryStep(eta, p);
+          eta = std::fmin(inside, std::fmax(-inside, retried));
+        }
+      }
+      out[i + j] = eta;
+    }
+  }
+  // The exact steps are counted by qNoise, as for double
+  if (k != STEP_EXACT && k != STEP_RETRY)
+    QNOISE_COUNT(stats.attempts[0] += n);
+  return eta;
+}
+
+/*
+ * Scheduled versions: each piece of the schedule is a call of the batch
+ * function with its own qNoiseParams. When the support shrinks between
+ * pieces, a value left outside is brought back by the step for q<1 (the
+ * reset of the retry scheme or the root of the implicit one).
+ */
+template <class Engine>
+template <class T>
+T qNoiseGenT<Engine>::scheduled(T *out, size_t n, T eta,
+                                const qNoiseSchedule &s, size_t start) {
+  size_t i = 0;
+  while (i < n) {
+    size_t end;
+    qNoiseParams p = s.piece(start + i, end);
+    size_t size = std::min(n - i, end - start - i);
+    eta = qNoise(out + i, size, eta, p);
+    i += size;
+  }
+  return eta;
+}
+
+template <class Engine>
+double qNoiseGenT<Engine>::qNoise(double *out, size_t n, double eta,
+                                  const qNoiseSchedule &s, size_t start) {
+  return scheduled(out, n, eta, s, start);
+}
+
+template <class Engine>
+float qNoiseGenT<Engine>::qNoise(float *out, size_t n, float eta,
+                                 const qNoiseSchedule &s, size_t start) {
+  return scheduled(out, n, eta, s, start);
+}
+
+// The generators provided by the library
+template class qNoiseGenT<std::mt19937>;
+template class qNoiseGenT<philox4x32>;
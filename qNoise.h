@@ -41,39 +41,372 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef QNOISEGEN_H
 #define QNOISEGEN_H
 
-#include <iostream>
-#include <climits>
-#include <cstdio>
-#include <ctime>
+#include <chrono>
 #include <cmath>
+#include <cstddef>
+#include <istream>
+#include <ostream>
 #include <random>
-#include <chrono>
-#include <ctime>
-#include <ratio>
+#include <vector>
+#include "qNoiseCore.h"
+#include "qNoiseGauss.h"
+
+// Version of the series: it changes whenever a seed no longer gives the same
+// series as before, so that series stored by qNoiseCache are not reused.
+#define QNOISE_SERIES_VERSION 1
+
+// Regime of the noise, fixed by q: each one has its own integration kernel.
+// QNOISE_BOUNDED (q<1): support (-etaCut, etaCut), with boundary handling.
+// QNOISE_GAUSSIAN (q=1): Ornstein-Uhlenbeck, exact update.
+// QNOISE_UNBOUNDED (q>1): Heun without any check of bounds.
+enum qNoiseRegime { QNOISE_BOUNDED, QNOISE_GAUSSIAN, QNOISE_UNBOUNDED };
+
+/*
+ * Parameters of the noise together with every constant derived from them.
+ * Build it once and reuse it while tau, q and H stay the same: the functions
+ * of qNoiseGen that receive it do no exp or sqrt on each sample, and the
+ * regime is chosen once per call instead of on each sample.
+ */
+struct qNoiseParams {
+    double tau, q, H;
+    double sqrt_H;    // sqrt(H)
+    double invTau;    // 1/tau
+    double tauQm1;    // tau*(q-1)
+    double etaCut;    // bound of the support, only finite for q<1
+    double decay;     // exp(-H/tau), Ornstein-Uhlenbeck decay per step
+    double diffusion; // sqrt((1-exp(-2H/tau))/2/tau), Ornstein-Uhlenbeck amplitude
+    double driftH;    // H/tau, factor of the drift in a Heun step
+    double noiseH;    // sqrt(H)/tau, factor of the Gaussian draw in a Heun step
+    qNoiseRegime regime;
+
+    qNoiseParams(double tau, double q, double H);
+    // Parameters for qNoiseNorm, where tau and the variance are independent of q
+    static qNoiseParams norm(double tau, double q, double H);
+};
+
+/*
+ * Schedule of tau, q and H along a series, for non-stationary noise. Each
+ * knot sets the parameters from its step (the index of the sample, t/H) on.
+ * With SCHEDULE_CONSTANT they are kept until the next knot; with
+ * SCHEDULE_LINEAR they are interpolated linearly to the next knot, in pieces
+ * of resolution steps that take the parameters of their midpoint. Before the
+ * first knot and after the last one the parameters are those of the knot.
+ * The batch functions of qNoiseGen build the qNoiseParams once per piece and
+ * run the kernel of its regime over the whole piece.
+ */
+enum qNoiseInterpolation { SCHEDULE_CONSTANT, SCHEDULE_LINEAR };
+
+struct qNoiseSchedule {
+    struct knot {
+        size_t step;
+        double tau, q, H;
+    };
+    std::vector<knot> knots;  // sorted by step
+    qNoiseInterpolation interpolation;
+    size_t resolution;        // steps per piece of SCHEDULE_LINEAR, at least 1
+
+    // A resolution of 0 is taken as 1
+    explicit qNoiseSchedule(qNoiseInterpolation interpolation = SCHEDULE_CONSTANT,
+                            size_t resolution = 256)
+        : interpolation(interpolation),
+          resolution(resolution > 0 ? resolution : 1) {}
+    // Add a knot, replacing the one at the same step if there is one
+    void add(size_t step, double tau, double q, double H);
+    // Parameters of the piece containing step, which ends before end.
+    // The schedule needs at least one knot.
+    qNoiseParams piece(size_t step, size_t &end) const;
+};
+
+/*
+ * Counters of the boundary rejection loop of qNoise, which is only active
+ * for q<1. An attempt of the Heun step that leaves the support is retried
+ * up to 10 times (phase 1), then up to 10 more times after an
+ * Ornstein-Uhlenbeck step (phase 2), and then the value is reset near
+ * etaCut (phase 3). Every step of qNoise, of any q, is counted in attempts,
+ * the same way by the single sample, batch and float32 versions and by
+ * qNoiseMulti. They are only collected when the library is compiled
+ * with QNOISE_STATS defined (for the whole build), otherwise they cost
+ * nothing and stay at zero.
+ */
+struct qNoiseStats {
+    unsigned long long retries[2];    // rejected attempts in phases 1 and 2
+    unsigned long long resets;        // hard resets (phase 3)
+    unsigned long long wastedDraws;   // Gaussian draws spent on retries
+    unsigned long long attempts[22];  // steps by number of rejected attempts
+                                      // (0 to 20, 21 for a reset)
+};
+
+// A single statement either way, so that it can be the body of an if
+#ifdef QNOISE_STATS
+#define QNOISE_COUNT(x) do { x; } while (0)
+#else
+#define QNOISE_COUNT(x) do { } while (0)
+#endif
+
+/*
+ * Draw of a Gaussian variate from the engine of the generator. The generic
+ * version uses std::normal_distribution. Counter-based engines use a whole
+ * block per variate so that the variate i only depends on the key and i.
+ * discard skips z variates: by drawing them in the generic version, and in
+ * O(1) on counter-based engines.
+ */
+template <class Engine> struct qNoiseNormal {
+    std::normal_distribution<double> dist;
+    double operator()(Engine &e) { return dist(e); }
+    void discard(Engine &e, unsigned long long z) {
+        for (; z > 0; z--)
+            dist(e);
+    }
+    void reset() { dist.reset(); }
+    void save(std::ostream &os) const { os << dist; }
+    void load(std::istream &is) { is >> dist; }
+};
+
+template <> struct qNoiseNormal<philox4x32> {
+    double operator()(philox4x32 &e) { return e.normal(); }
+    void discard(philox4x32 &e, unsigned long long z) { e.seek(e.tell() + z); }
+    void reset() {}
+    void save(std::ostream &os) const { os << 0; }
+    void load(std::istream &is) {
+        int none;
+        is >> none;
+    }
+};
 
-class qNoiseGen {
-    double potQNoisePrime(double eta, double tau, double q);
+/*
+ * The generator, templated on the random engine used by the default backend.
+ * qNoiseGen uses std::mt19937. qNoiseGenPhilox uses the counter-based
+ * philox4x32: a state of a few words instead of 2.5 KB and O(1) discard, so
+ * any window of a realization can be regenerated from the position of the
+ * engine (engine().tell() and engine().seek()) and the value of the noise.
+ * Both are instantiated in qNoise.cpp.
+ */
+template <class Engine> class qNoiseGenT {
+    double potQNoisePrime(double eta, double invTau, double tauQm1);
+    double heunStep(double eta, double tau, double H, double sqrt_H,
+                    double invTau, double tauQm1, double etaCut,
+                    int countError = 0);
+    // Heun step of q<1 whose first attempt, made by the caller, left the
+    // support. It is counted as heunStep counts it and the retries go on from
+    // the second attempt.
+    double retryStep(double eta, const qNoiseParams &p) {
+        QNOISE_COUNT(stats.retries[0]++);
+        QNOISE_COUNT(stats.wastedDraws++);
+        return heunStep(eta, p.tau, p.H, p.sqrt_H, p.invTau, p.tauQm1,
+                        p.etaCut, 1);
+    }
+    // Steps of q<1 without rejection and of q>1, on the kernels of
+    // qNoiseCore.h
+    double boundedStep(double eta, double driftH, double noiseH,
+                       double tauQm1, double etaCut) {
+        QNOISE_COUNT(stats.attempts[0]++);
+        return qnoise::implicit(eta, nextGauss(), driftH, noiseH, tauQm1,
+                                etaCut);
+    }
+    double unboundedStep(double eta, double driftH, double noiseH,
+                         double tauQm1) {
+        QNOISE_COUNT(stats.attempts[0]++);
+        return qnoise::heun(eta, nextGauss(), driftH, noiseH, tauQm1);
+    }
+    // Kernels of a step, one per regime and scheme, chosen once per call
+    enum stepKernel { STEP_RETRY, STEP_IMPLICIT, STEP_EXACT, STEP_UNBOUNDED };
+    stepKernel kernel(const qNoiseParams &p) const {
+        if (p.regime == QNOISE_GAUSSIAN)
+            return STEP_EXACT;
+        if (p.regime == QNOISE_UNBOUNDED)
+            return STEP_UNBOUNDED;
+        return bounded == BOUNDED_IMPLICIT ? STEP_IMPLICIT : STEP_RETRY;
+    }
+    // One step with the kernel k. k is a constant of the template, so the
+    // choice is resolved at compile time and the loops of integrate have no
+    // branch on the regime.
+    template <int k> double step(double eta, const qNoiseParams &p) {
+        if (k == STEP_EXACT) {
+            QNOISE_COUNT(stats.attempts[0]++);
+            return orsUhl(eta, p);
+        }
+        if (k == STEP_UNBOUNDED)
+            return unboundedStep(eta, p.driftH, p.noiseH, p.tauQm1);
+        if (k == STEP_IMPLICIT)
+            return boundedStep(eta, p.driftH, p.noiseH, p.tauQm1, p.etaCut);
+        return heunStep(eta, p.tau, p.H, p.sqrt_H, p.invTau, p.tauQm1,
+                        p.etaCut);
+    }
+    template <int k>
+    double integrate(double *out, size_t n, double eta, const qNoiseParams &p);
+    template <int k>
+    float integrate(float *out, size_t n, float eta, const qNoiseParams &p);
+    template <class T>
+    T scheduled(T *out, size_t n, T eta, const qNoiseSchedule &s,
+                size_t start);
+    friend class qNoiseMulti;
+    friend class qNoisePool;
     typedef std::chrono::high_resolution_clock myclock;
     myclock::time_point beginning;
     unsigned seed;
-    std::mt19937 generator;
-    std::normal_distribution<double> randNorm;
+    long long stream;  // of seedStream, 0 for seedManual, -1 for the timer
+    Engine generator;
+    qNoiseNormal<Engine> randNorm;
     std::uniform_real_distribution<double> uniform;
+    // Ziggurat backend: blocks of variates drawn from xoshiro256++
+    xoshiro256pp fastGenerator;
+    zigguratNormal ziggurat;
+    std::vector<double> gaussBuffer;
+    size_t gaussPos;
+    int bounded;
+    void refillGauss();
+    double nextGauss() {
+        if (gaussBuffer.empty())
+            return randNorm(generator);
+        if (gaussPos == gaussBuffer.size())
+            refillGauss();
+        return gaussBuffer[gaussPos++];
+    }
+    double nextUniform() {
+        if (gaussBuffer.empty())
+            return uniform(generator);
+        return uniform(fastGenerator);
+    }
+    void seedEngine(unsigned UserSeed, const xoshiro256pp &engine);
+#ifdef QNOISE_STATS
+    qNoiseStats stats;
+#endif
 
 public:
+    // Source of the Gaussian variates used by every function.
+    // GAUSS_STD: std::normal_distribution over Engine (default).
+    // GAUSS_ZIGGURAT: Ziggurat over xoshiro256++, drawn in blocks. Every
+    // random number then comes from xoshiro256++.
+    enum gaussBackend { GAUSS_STD, GAUSS_ZIGGURAT };
+    void setGaussBackend(gaussBackend backend);
+
+    // Integration scheme of qNoise for q<1, where the noise is bounded.
+    // BOUNDED_RETRY: Heun, retrying the steps that leave the support
+    // (default).
+    // BOUNDED_IMPLICIT: trapezoidal step with the drift of the new point
+    // taken implicitly. The drift diverges at the bounds, so the new point is
+    // always inside: one Gaussian draw and a constant cost per step.
+    enum boundedScheme { BOUNDED_RETRY, BOUNDED_IMPLICIT };
+    void setBoundedScheme(boundedScheme scheme) { bounded = scheme; }
+    gaussBackend getGaussBackend() const {
+        return gaussBuffer.empty() ? GAUSS_STD : GAUSS_ZIGGURAT;
+    }
+    boundedScheme getBoundedScheme() const { return boundedScheme(bounded); }
+
     void seedManual(unsigned UserSeed);
     void seedTimer();
+    // Seeding for parallel use: stream k of UserSeed is 2^128 draws apart of
+    // stream k+1, so different streams never overlap. It selects the Ziggurat
+    // backend, whose generator is the one split in streams. The engine of
+    // the std backend is seeded from the stream as well, so the series only
+    // depends on the seed and the stream with either backend (but only the
+    // Ziggurat streams are guaranteed not to overlap). O(stream) cost, see
+    // qNoisePool for many streams.
+    void seedStream(unsigned UserSeed, unsigned stream);
+    // Last seed and its stream (0 for seedManual). The stream is -1 when the
+    // seed came from the timer (or a qNoisePool path), which cannot be
+    // reproduced.
+    unsigned getSeed() const { return seed; }
+    long long getStream() const { return stream; }
+    // Skip z Gaussian variates of the active backend: the draws of z steps
+    // of orsUhl, of qNoise for q>=1 or with BOUNDED_IMPLICIT (a retried step
+    // of BOUNDED_RETRY takes more). O(1) for philox4x32 with GAUSS_STD, O(z)
+    // otherwise. Words of the engine are skipped with engine().discard().
+    void discard(unsigned long long z);
+    Engine &engine() { return generator; }
+    // Counters of the boundary rejection loop, see qNoiseStats.
+    qNoiseStats getStats() const {
+#ifdef QNOISE_STATS
+        return stats;
+#else
+        return qNoiseStats();
+#endif
+    }
+    void resetStats() { QNOISE_COUNT(stats = qNoiseStats()); }
+
+    // Complete state of the generator as text, to checkpoint a run and
+    // continue it later with exactly the same sequence.
+    void saveState(std::ostream &os) const;
+    bool loadState(std::istream &is);
     double gaussWN();
     double orsUhl(double x, double tau, double H);
-    double qNoise(double x, double tau, double q, double H, double sqrt_H);
-    double qNoiseNorm(double x, double tau, double q, double H, double sqrt_H);
+    double qNoise(double x, double tau, double q, double H, double sqrt_H = -1);
+    double qNoiseNorm(double x, double tau, double q, double H,
+                      double sqrt_H = -1);
+
+    // Batch versions: write n consecutive samples starting from eta into out
+    // and return the last one, so long series can be generated in chunks.
+    void gaussWN(double *out, size_t n);
+    double orsUhl(double *out, size_t n, double eta, double tau, double H);
+    double qNoise(double *out, size_t n, double eta, double tau, double q,
+                  double H);
+    double qNoiseNorm(double *out, size_t n, double eta, double tau, double q,
+                      double H);
+
+    // Versions with precomputed parameters. For qNoiseNorm build them with
+    // qNoiseParams::norm and call qNoise. The single sample ones are inline.
+    double orsUhl(double x, const qNoiseParams &p) {
+        return qnoise::exact(x, nextGauss(), p.decay, p.diffusion);
+    }
+    double qNoise(double x, const qNoiseParams &p) {
+        switch (kernel(p)) {
+        case STEP_EXACT:
+            return step<STEP_EXACT>(x, p);
+        case STEP_UNBOUNDED:
+            return step<STEP_UNBOUNDED>(x, p);
+        case STEP_IMPLICIT:
+            return step<STEP_IMPLICIT>(x, p);
+        default:
+            return step<STEP_RETRY>(x, p);
+        }
+    }
+    double orsUhl(double *out, size_t n, double eta, const qNoiseParams &p);
+    double qNoise(double *out, size_t n, double eta, const qNoiseParams &p);
 
-    qNoiseGen() {
+    // Float32 versions: the state, the step and the bounds are single
+    // precision, only the Gaussian draws are taken in double (from the same
+    // backend) and rounded. Each step rounds to 24 bits, which adds a noise of
+    // relative variance about 1e-14 tau/H per step, negligible for the whole
+    // grid of the unit tests (tau/H up to 1e5), where the PDFs match as well
+    // as in double. For q<1 the values stay inside the float support.
+    void gaussWN(float *out, size_t n);
+    float orsUhl(float *out, size_t n, float eta, const qNoiseParams &p);
+    float qNoise(float *out, size_t n, float eta, const qNoiseParams &p);
+
+    // Value drawn from the stationary PDF of qNoise,
+    // P(x) ~ (1 - tau (1-q) x^2)^(1/(1-q)) for q<3, with the generalized
+    // Box-Muller method. A series started from it is in equilibrium from its
+    // first point, without a transient. For qNoiseNorm use the parameters of
+    // qNoiseParams::norm. For q>=3 there is no stationary PDF: it returns NaN
+    // and takes no draw.
+    double qNoiseStationary(double tau, double q);
+    double qNoiseStationary(const qNoiseParams &p) {
+        return qNoiseStationary(p.tau, p.q);
+    }
+    // Starting value of a series: qNoiseStationary for q<3; for q>=3, where
+    // it has no value, a small Gaussian value after a transient of 2 tau/H
+    // steps, as test_qNoise did before. Always finite.
+    double qNoiseStart(const qNoiseParams &p);
+
+    // Series with parameters that change along it as set by a schedule. start
+    // is the step of out[0] in the schedule, to generate it in chunks.
+    double qNoise(double *out, size_t n, double eta, const qNoiseSchedule &s,
+                  size_t start = 0);
+    float qNoise(float *out, size_t n, float eta, const qNoiseSchedule &s,
+                 size_t start = 0);
+
+    qNoiseGenT() {
         std::normal_distribution<double> randNorm(0.0, 1.0);
         std::uniform_real_distribution<double> uniform(0.0,0.99);
         beginning = myclock::now();
+        gaussPos = 0;
+        bounded = BOUNDED_RETRY;
+        resetStats();
         seedTimer();
     }
 };
 
+typedef qNoiseGenT<std::mt19937> qNoiseGen;
+typedef qNoiseGenT<philox4x32> qNoiseGenPhilox;
+
 #endif  // QNOISEGEN_H
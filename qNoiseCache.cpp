@@ -0,0 +1,263 @@
+/*
+qNoise: A generator of non-Gaussian colored noise
+Copyright © 2021, Juan Ignacio Deza
+email: ignacio.deza@uwe.ac.uk
+
+Description
+qNoise is a non-gaussian colored random noise generator. It is a handy source of
+self-correlated noise for a great variety of applications. It depends on two
+parameters only: tau for controlling the autocorrelation, and q for controlling
+the statistics. This noise tends smoothly  for q = 1 to an  Ornstein-Uhlenbeck
+(colored gaussian) noise with autocorrelation tau. for q < 1 it is bounded noise
+and it is supra-Gaussian for q > 1. The noise is generated  via a stochastic
+differential equation using the Heun method (a second order Runge-Kutta type
+integration scheme) and it is implemented as a stand-alone library in c++. It
+Useful as input for numerical simulations, as a source of noise for controlling
+experiments using synthetic noise via micro-controllers and for a wide variety
+of applications.
+
+Requirements
+It is a stand-alone library with no dependencies other than the standard
+libraries. Due to it's use of some functions from the <random> library the
+library currently works on c++11 or higher only. This should be OK for most Macs
+and new Linux systems. In some older systems it is possible that you need to add
+`-std=gnu++11` to your compilation flags.
+
+Licence
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+#include "qNoiseCache.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define QNOISE_HAVE_MMAP
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// Mark the file as the most recently used, with a resolution of nanoseconds
+static void markUsed(const std::string &name) {
+  struct timespec now[2];
+  clock_gettime(CLOCK_REALTIME, &now[0]);
+  now[1] = now[0];
+  utimensat(AT_FDCWD, name.c_str(), now, 0);
+}
+
+// Modification time in nanoseconds
+static long long usedTime(const struct stat &info) {
+#ifdef __APPLE__
+  const struct timespec &t = info.st_mtimespec;
+#else
+  const struct timespec &t = info.st_mtim;
+#endif
+  return t.tv_sec * 1000000000LL + t.tv_nsec;
+}
+#endif
+
+qNoiseCache::qNoiseCache(const std::string &directory, size_t maxBytes)
+    : directory(directory), maxBytes(maxBytes) {}
+
+// Shortest text of x that reads back as x, so that the names are exact.
+static std::string exactText(double x) {
+  for (int precision = 6;; precision++) {
+    std::ostringstream text;
+    text.precision(precision);
+    text << x;
+    if (precision == 17 || std::stod(text.str()) == x)
+      return text.str();
+  }
+}
+
+std::string qNoiseCache::fileName(const qNoiseGen &gen,
+                                  const qNoiseParams &p) const {
+  std::ostringstream name;
+  name << directory << "/qNoise_" << gen.getSeed() << "_" << gen.getStream()
+       << (gen.getGaussBackend() == qNoiseGen::GAUSS_ZIGGURAT ? "_zig"
+                                                              : "_std")
+       << (gen.getBoundedScheme() == qNoiseGen::BOUNDED_IMPLICIT
+               ? "_implicit"
+               : "_retry")
+       << "_" << exactText(p.tau) << "_" << exactText(p.H) << "_"
+       << exactText(p.q) << "_v" << QNOISE_SERIES_VERSION << ".map";
+  return name.str();
+}
+
+bool qNoiseCache::get(qNoiseGen &gen, const qNoiseParams &p, size_t n,
+                      qNoiseMap &series) const {
+#ifdef QNOISE_HAVE_MMAP
+  if (gen.getStream() < 0)
+    return false;
+  mkdir(directory.c_str(), 0755);  // if it does not exist
+  std::string name = fileName(gen, p), stateName = name + ".state";
+  qNoiseCheckpoint checkpoint;
+  bool cached = checkpoint.load(stateName) && checkpoint.tau == p.tau &&
+                checkpoint.q == p.q && checkpoint.H == p.H;
+  if (cached && checkpoint.n >= n) {
+    if (!series.openRead(name, n))
+      return false;
+    markUsed(name);
+    return true;
+  }
+
+  // Generate the points missing, with the state of gen kept aside.
+  std::ostringstream saved;
+  gen.saveState(saved);
+  unsigned seed = gen.getSeed();
+  long long stream = gen.getStream();
+  qNoiseGen::gaussBackend backend = gen.getGaussBackend();
+  size_t start = 0;
+  double eta = 0;
+  if (cached) {
+    std::istringstream state(checkpoint.state);
+    cached = gen.loadState(state);
+    start = checkpoint.n;
+    eta = checkpoint.eta;
+  }
+  if (!cached) {
+    if (stream == 0)
+      gen.seedManual(seed);
+    else
+      gen.seedStream(seed, unsigned(stream));
+    gen.setGaussBackend(backend);
+    start = 0;
+    eta = gen.qNoiseStart(p);
+  }
+  qNoiseMap map;
+  bool ok = map.open(name, n);
+  if (ok) {
+    const size_t chunk = 1 << 20;
+    for (size_t i = start; i < n; i += chunk)
+      eta = gen.qNoise(map.writableData() + i, std::min(chunk, n - i), eta, p);
+    map.close();
+    std::ostringstream state;
+    gen.saveState(state);
+    checkpoint.tau = p.tau;
+    checkpoint.q = p.q;
+    checkpoint.H = p.H;
+    checkpoint.n = n;
+    checkpoint.eta = eta;
+    checkpoint.state = state.str();
+    ok = checkpoint.save(stateName);
+  }
+  std::istringstream restore(saved.str());
+  gen.loadState(restore);
+  if (!ok) {
+    // Leave nothing half written
+    unlink(name.c_str());
+    unlink(stateName.c_str());
+    return false;
+  }
+  if (!series.openRead(name, n))
+    return false;
+  markUsed(name);
+  evict(name);
+  return true;
+#else
+  (void)gen;
+  (void)p;
+  (void)n;
+  (void)series;
+  return false;
+#endif
+}
+
+bool qNoiseCache::contains(const qNoiseGen &gen, const qNoiseParams &p,
+                           size_t n) const {
+#ifdef QNOISE_HAVE_MMAP
+  if (gen.getStream() < 0)
+    return false;
+  std::string name = fileName(gen, p);
+  qNoiseCheckpoint checkpoint;
+  return access(name.c_str(), R_OK) == 0 &&
+         checkpoint.load(name + ".state") && checkpoint.tau == p.tau &&
+         checkpoint.q == p.q && checkpoint.H == p.H && checkpoint.n >= n;
+#else
+  (void)gen;
+  (void)p;
+  (void)n;
+  return false;
+#endif
+}
+
+void qNoiseCache::clear() const {
+#ifdef QNOISE_HAVE_MMAP
+  DIR *dir = opendir(directory.c_str());
+  if (!dir)
+    return;
+  std::vector<std::string> names;
+  while (struct dirent *file = readdir(dir)) {
+    std::string base = file->d_name;
+    if (base.compare(0, 7, "qNoise_") == 0)
+      names.push_back(directory + "/" + base);
+  }
+  closedir(dir);
+  for (size_t i = 0; i < names.size(); i++)
+    unlink(names[i].c_str());
+  rmdir(directory.c_str());  // only if it is empty
+#endif
+}
+
+/*
+ * Remove the least recently used series (by modification time, which is
+ * set on each use) until the cache fits in maxBytes, keeping keep.
+ * Series still mapped stay readable until they are closed.
+ */
+void qNoiseCache::evict(const std::string &keep) const {
+#ifdef QNOISE_HAVE_MMAP
+  struct entry {
+    long long used;
+    size_t bytes;
+    std::string name;
+    bool operator<(const entry &other) const { return used < other.used; }
+  };
+  std::vector<entry> entries;
+  size_t total = 0;
+  DIR *dir = opendir(directory.c_str());
+  if (!dir)
+    return;
+  while (struct dirent *file = readdir(dir)) {
+    std::string base = file->d_name;
+    if (base.compare(0, 7, "qNoise_") != 0 || base.size() < 4 ||
+        base.compare(base.size() - 4, 4, ".map") != 0)
+      continue;
+    entry e;
+    e.name = directory + "/" + base;
+    struct stat info, stateInfo;
+    if (stat(e.name.c_str(), &info) != 0)
+      continue;
+    e.used = usedTime(info);
+    e.bytes = info.st_size;
+    if (stat((e.name + ".state").c_str(), &stateInfo) == 0)
+      e.bytes += stateInfo.st_size;
+    total += e.bytes;
+    entries.push_back(e);
+  }
+  closedir(dir);
+  std::sort(entries.begin(), entries.end());
+  for (size_t i = 0; i < entries.size() && total > maxBytes; i++) {
+    if (entries[i].name == keep)
+      continue;
+    unlink(entries[i].name.c_str());
+    unlink((entries[i].name + ".state").c_str());
+    total -= entries[i].bytes;
+  }
+#else
+  (void)keep;
+#endif
+}
@@ -0,0 +1,90 @@
+/*
+qNoise: A generator of non-Gaussian colored noise
+Copyright © 2021, Juan Ignacio Deza
+email: ignacio.deza@uwe.ac.uk
+
+Description
+qNoise is a non-gaussian colored random noise generator. It is a handy source of
+self-correlated noise for a great variety of applications. It depends on two
+parameters only: tau for controlling the autocorrelation, and q for controlling
+the statistics. This noise tends smoothly  for q = 1 to an  Ornstein-Uhlenbeck
+(colored gaussian) noise with autocorrelation tau. for q < 1 it is bounded noise
+and it is supra-Gaussian for q > 1. The noise is generated  via a stochastic
+differential equation using the Heun method (a second order Runge-Kutta type
+integration scheme) and it is implemented as a stand-alone library in c++. It
+Useful as input for numerical simulations, as a source of noise for controlling
+experiments using synthetic noise via micro-controllers and for a wide variety
+of applications.
+
+Requirements
+It is a stand-alone library with no dependencies other than the standard
+libraries. Due to it's use of some functions from the <random> library the
+library currently works on c++11 or higher only. This should be OK for most Macs
+and new Linux systems. In some older systems it is possible that you need to add
+`-std=gnu++11` to your compilation flags.
+
+Licence
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef QNOISECACHE_H
+#define QNOISECACHE_H
+
+#include <string>
+#include "qNoise.h"
+#include "qNoiseIO.h"
+
+/*
+ * qNoiseCache keeps series of qNoise on disk so that the same realization is
+ * generated only once. A series is the one given by a freshly seeded
+ * generator: it starts from the stationary value drawn after seeding (see
+ * qNoiseStart) and is integrated with the batch qNoise. It is stored as
+ * raw float64 with a checkpoint (as the format map of test_qNoise) in a file
+ * whose name holds everything the series depends on: the seed and its
+ * stream, the Gaussian backend, the scheme for q<1, tau, H, q and
+ * QNOISE_SERIES_VERSION. A request for n points maps the first n points of
+ * the file read only; a longer one extends the file from its checkpoint.
+ * Generators seeded by the timer are never cached. When the files exceed
+ * maxBytes, the least recently used are removed: each use sets the
+ * modification time of the file to the current time in nanoseconds. Only
+ * available on POSIX systems.
+ */
+class qNoiseCache {
+    std::string directory;
+    size_t maxBytes;
+
+    std::string fileName(const qNoiseGen &gen, const qNoiseParams &p) const;
+    void evict(const std::string &keep) const;
+
+public:
+    explicit qNoiseCache(const std::string &directory = "qNoise_cache",
+                         size_t maxBytes = size_t(1) << 30);
+
+    /*
+     * Map in series the first n points of the series of gen (its seed,
+     * stream and settings) with the parameters p, generating what is not
+     * cached. The state of gen is not changed. Returns false, doing nothing,
+     * if gen is seeded by the timer or the cache cannot be used; the series
+     * must then be generated directly.
+     */
+    bool get(qNoiseGen &gen, const qNoiseParams &p, size_t n,
+             qNoiseMap &series) const;
+    // Whether the first n points of that series are cached
+    bool contains(const qNoiseGen &gen, const qNoiseParams &p,
+                  size_t n) const;
+    // Remove every series, and the directory if nothing else is left in it
+    void clear() const;
+};
+
+#endif  // QNOISECACHE_H
@@ -0,0 +1,219 @@
+/*
+qNoise: A generator of non-Gaussian colored noise
+Copyright © 2021, Juan Ignacio Deza
+email: ignacio.deza@uwe.ac.uk
+
+Description
+qNoise is a non-gaussian colored random noise generator. It is a handy source of
+self-correlated noise for a great variety of applications. It depends on two
+parameters only: tau for controlling the autocorrelation, and q for controlling
+the statistics. This noise tends smoothly  for q = 1 to an  Ornstein-Uhlenbeck
+(colored gaussian) noise with autocorrelation tau. for q < 1 it is bounded noise
+and it is supra-Gaussian for q > 1. The noise is generated  via a stochastic
+differential equation using the Heun method (a second order Runge-Kutta type
+integration scheme) and it is implemented as a stand-alone library in c++. It
+Useful as input for numerical simulations, as a source of noise for controlling
+experiments using synthetic noise via micro-controllers and for a wide variety
+of applications.
+
+Requirements
+It is a stand-alone library with no dependencies other than the standard
+libraries. Due to it's use of some functions from the <random> library the
+library currently works on c++11 or higher only. This should be OK for most Macs
+and new Linux systems. In some older systems it is possible that you need to add
+`-std=gnu++11` to your compilation flags.
+
+Licence
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef QNOISECORE_H
+#define QNOISECORE_H
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <random>
+
+/*
+ * Header-only core of qNoise. Everything is inline and templated on the
+ * floating point type, so the step can be inlined into the loops of the
+ * caller and the same code gives a float or a double series. The step
+ * functions only take the Gaussian draw as input: given the draws they are
+ * deterministic, and the Heun and exact steps are constexpr.
+ * qNoiseGen (qNoise.h) uses these kernels and adds the seeding, the Gaussian
+ * backends, the retry scheme for q<1 and the saving of the state.
+ */
+namespace qnoise {
+
+// Regimes of the noise, to choose the kernel of Generator at compile time.
+struct Bounded {};    // q<1, rejection-free implicit step
+struct Gaussian {};   // q=1, exact Ornstein-Uhlenbeck update
+struct Unbounded {};  // q>1, Heun step
+
+// Parameters and derived constants, see qNoiseParams.
+template <class Real> struct Params {
+    Real tau, q, H;
+    Real invTau;     // 1/tau
+    Real tauQm1;     // tau*(q-1)
+    Real etaCut;     // bound of the support, only finite for q<1
+    Real driftH;     // H/tau, as H * invTau
+    Real noiseH;     // sqrt(H)/tau, as sqrt(H) * invTau
+    Real decay;      // exp(-H/tau)
+    Real diffusion;  // sqrt((1-exp(-2H/tau))/2/tau)
+
+    // The factors are rounded as in qNoiseParams, so that in double the
+    // steps are the same as those of qNoiseGen
+    Params(Real tau, Real q, Real H)
+        : tau(tau), q(q), H(H), invTau(1 / tau), tauQm1(tau * (q - 1)),
+          etaCut(1 / std::sqrt(tau * (1 - q))), driftH(H * invTau),
+          noiseH(std::sqrt(H) * invTau), decay(std::exp(-H / tau)),
+          diffusion(std::sqrt((1 - std::exp(-2 / tau * H)) / 2 / tau)) {}
+    // Parameters of qNoiseNorm
+    static Params norm(Real tau, Real q, Real H) {
+        return Params(tau * (5 - 3 * q) / 2, q, H);
+    }
+};
+
+// Drift of qNoise times tau: eta / (1 + tau (q-1) eta^2)
+template <class Real> constexpr Real drift(Real eta, Real tauQm1) {
+    return eta / (1 + eta * eta * tauQm1);
+}
+
+// Heun step from eta with the drift d and the noise term l already computed
+template <class Real>
+constexpr Real heunFrom(Real eta, Real d, Real l, Real driftH, Real tauQm1) {
+    return eta - driftH / 2 * (d + drift(eta + driftH * d + l, tauQm1)) + l;
+}
+
+// Heun step of qNoise from eta with the Gaussian draw g
+template <class Real>
+constexpr Real heun(Real eta, Real g, Real driftH, Real noiseH,
+                    Real tauQm1) {
+    return heunFrom(eta, drift(eta, tauQm1), noiseH * g, driftH, tauQm1);
+}
+
+// Exact Ornstein-Uhlenbeck update from eta with the Gaussian draw g
+template <class Real>
+constexpr Real exact(Real eta, Real g, Real decay, Real diffusion) {
+    return eta * decay + diffusion * g;
+}
+
+/*
+ * Solution in (-etaCut, etaCut) of x + a * H * f(x) = b, where
+ * f(x) = x / (tau * (1 - x^2 / etaCut^2)) is the drift of qNoise for q<1 and
+ * a * H / tau is given as aH. With u = |x| / etaCut and B = |b| / etaCut it is
+ * the root in [0, min(B, 1)) of h(u) = (u - B) (1 - u^2) + aH u, the middle
+ * one of the cubic, where h is increasing. It lies between the explicit
+ * predictor B / (1 + aH), which takes the drift as linear, and the root near
+ * the bound with 1 + u taken as 2, 1 - d with d^2 + (B - 1) d = aH / 2. The
+ * one with the smaller |h| starts three Halley iterations kept inside that
+ * bracket, which reach the root to rounding for any B and aH. The cost is
+ * constant and the selects have no side effects, so they become blends and a
+ * loop over it is vectorized, given -fno-trapping-math (set by
+ * qNoiseMulti.cpp) and -fno-math-errno (otherwise sqrt keeps a call for
+ * errno). The trigonometric closed form is kept as a reference in the tests.
+ */
+template <class Real> inline Real boundedRoot(Real b, Real etaCut, Real aH) {
+    Real B = std::fabs(b) / etaCut;
+    Real m = B - 1, s = std::sqrt(m * m + 2 * aH);
+    // d = aH / (m + s) = (s - m) / 2, in the form without cancellation
+    Real d = (m > 0 ? aH : (s - m) / 2) / (m > 0 ? m + s : 1);
+    Real lo = d < 1 ? 1 - d : 0;
+    Real hi = B < 1 + aH ? B / (1 + aH) : 1;
+    Real hLo = (lo - B) * (1 - lo * lo) + aH * lo;
+    Real hHi = (hi - B) * (1 - hi * hi) + aH * hi;
+    Real u = std::fabs(hLo) < std::fabs(hHi) ? lo : hi;
+    for (int i = 0; i < 3; i++) {
+        Real h = (u - B) * (1 - u * u) + aH * u;
+        Real h1 = 1 + aH - 3 * u * u + 2 * B * u;
+        Real h2 = 2 * B - 6 * u;
+        u -= 2 * h * h1 / (2 * h1 * h1 - h * h2);
+        u = u < lo ? lo : u > hi ? hi : u;
+    }
+    // Keep it strictly inside the support against rounding
+    Real limit = 1 - 4 * std::numeric_limits<Real>::epsilon();
+    return std::copysign(etaCut * (u < limit ? u : limit), b);
+}
+
+// Rejection-free step for q<1 from eta with the Gaussian draw g
+template <class Real>
+inline Real implicit(Real eta, Real g, Real driftH, Real noiseH, Real tauQm1,
+                     Real etaCut) {
+    return boundedRoot(eta - driftH / 2 * drift(eta, tauQm1) + noiseH * g,
+                       etaCut, driftH / 2);
+}
+
+/*
+ * A generator of one regime, e.g.
+ *   qnoise::Generator<float, std::mt19937, qnoise::Unbounded>
+ *       gen(qnoise::Params<float>(tau, q, H), seed);
+ *   eta = gen.generate(out, n, eta);
+ * The regime must match q: Bounded for q<1, Gaussian for q=1 and Unbounded
+ * for q>1, which the constructor asserts (Unbounded is only the default).
+ * Rng is any standard random engine.
+ */
+template <class Real, class Rng = std::mt19937, class Regime = Unbounded>
+class Generator {
+    Params<Real> p;
+    Rng rng;
+    std::normal_distribution<Real> normal;
+
+    Real stepWith(Real eta, Real g, Bounded) const {
+        return implicit(eta, g, p.driftH, p.noiseH, p.tauQm1, p.etaCut);
+    }
+    Real stepWith(Real eta, Real g, Gaussian) const {
+        return exact(eta, g, p.decay, p.diffusion);
+    }
+    Real stepWith(Real eta, Real g, Unbounded) const {
+        return heun(eta, g, p.driftH, p.noiseH, p.tauQm1);
+    }
+    static bool inRegime(Real q, Bounded) { return q < 1; }
+    static bool inRegime(Real q, Gaussian) { return q == 1; }
+    static bool inRegime(Real q, Unbounded) { return q > 1; }
+
+public:
+    typedef Real value_type;
+
+    explicit Generator(const Params<Real> &p,
+                       typename Rng::result_type seed = Rng::default_seed)
+        : p(p), rng(seed) {
+        assert(inRegime(p.q, Regime()));
+    }
+
+    const Params<Real> &params() const { return p; }
+    Rng &engine() { return rng; }
+    void seed(typename Rng::result_type s) {
+        rng.seed(s);
+        normal.reset();
+    }
+
+    // One step from eta with the Gaussian draw g
+    Real step(Real eta, Real g) const { return stepWith(eta, g, Regime()); }
+    // One step from eta
+    Real operator()(Real eta) { return step(eta, normal(rng)); }
+    // n consecutive steps from eta written to out, returns the last one
+    Real generate(Real *out, size_t n, Real eta) {
+        for (size_t i = 0; i < n; i++) {
+            eta = step(eta, normal(rng));
+            out[i] = eta;
+        }
+        return eta;
+    }
+};
+
+}  // namespace qnoise
+
+#endif  // QNOISECORE_H
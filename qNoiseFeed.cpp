@@ -0,0 +1,97 @@
+/*
+qNoise: A generator of non-Gaussian colored noise
+Copyright © 2021, Juan Ignacio Deza
+email: ignacio.deza@uwe.ac.uk
+
+Description
+qNoise is a non-gaussian colored random noise generator. It is a handy source of
+self-correlated noise for a great variety of applications. It depends on two
+parameters only: tau for controlling the autocorrelation, and q for controlling
+the statistics. This noise tends smoothly  for q = 1 to an  Ornstein-Uhlenbeck
+(colored gaussian) noise with autocorrelation tau. for q < 1 it is bounded noise
+and it is supra-Gaussian for q > 1. The noise is generated  via a stochastic
+differential equation using the Heun method (a second order Runge-Kutta type
+integration scheme) and it is implemented as a stand-alone library in c++. It
+Useful as input for numerical simulations, as a source of noise for controlling
+experiments using synthetic noise via micro-controllers and for a wide variety
+of applications.
+
+Requirements
+It is a stand-alone library with no dependencies other than the standard
+libraries. Due to it's use of some functions from the <random> library the
+library currently works on c++11 or higher only. This should be OK for most Macs
+and new Linux systems. In some older systems it is possible that you need to add
+`-std=gnu++11` to your compilation flags.
+
+Licence
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <chrono>
+#include "qNoiseFeed.h"
+
+qNoiseFeed::qNoiseFeed(const qNoiseParams &p, size_t blockSize, size_t blocks)
+    : p(p), blockSize(blockSize > 0 ? blockSize : 1),
+      blocks(blocks > 1 ? blocks : 2), ring(this->blockSize * this->blocks),
+      running(false), eta(0), written(0), consumed(0), underrunCount(0),
+      current(0), pos(this->blockSize), reading(0), holding(false) {}
+
+void qNoiseFeed::start(double eta0) {
+  if (running)
+    return;
+  eta = eta0;
+  running = true;
+  producer = std::thread(&qNoiseFeed::produce, this);
+}
+
+void qNoiseFeed::stop() {
+  running = false;
+  if (producer.joinable())
+    producer.join();
+}
+
+// Producer thread: fill the free blocks and publish them in order.
+void qNoiseFeed::produce() {
+  size_t w = written.load(std::memory_order_relaxed);
+  while (running.load(std::memory_order_relaxed)) {
+    if (w - consumed.load(std::memory_order_acquire) == blocks) {
+      // The ring is full, the consumer is behind.
+      std::this_thread::sleep_for(std::chrono::microseconds(20));
+      continue;
+    }
+    eta = gen.qNoise(&ring[(w % blocks) * blockSize], blockSize, eta, p);
+    written.store(++w, std::memory_order_release);
+  }
+}
+
+// Consumer thread: release the block in use and take the next one if ready.
+bool qNoiseFeed::acquireBlock() {
+  if (holding) {
+    consumed.store(++reading, std::memory_order_release);
+    holding = false;
+  }
+  if (written.load(std::memory_order_acquire) == reading)
+    return false;
+  current = &ring[(reading % blocks) * blockSize];
+  pos = 0;
+  holding = true;
+  return true;
+}
+
+size_t qNoiseFeed::depth() const {
+  size_t ready = (written.load(std::memory_order_acquire) -
+                  consumed.load(std::memory_order_acquire)) * blockSize;
+  // Do not count what the consumer has already read of its block
+  return holding ? ready - pos : ready;
+}
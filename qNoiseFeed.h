@@ -0,0 +1,127 @@
+/*
+qNoise: A generator of non-Gaussian colored noise
+Copyright © 2021, Juan Ignacio Deza
+email: ignacio.deza@uwe.ac.uk
+
+Description
+qNoise is a non-gaussian colored random noise generator. It is a handy source of
+self-correlated noise for a great variety of applications. It depends on two
+parameters only: tau for controlling the autocorrelation, and q for controlling
+the statistics. This noise tends smoothly  for q = 1 to an  Ornstein-Uhlenbeck
+(colored gaussian) noise with autocorrelation tau. for q < 1 it is bounded noise
+and it is supra-Gaussian for q > 1. The noise is generated  via a stochastic
+differential equation using the Heun method (a second order Runge-Kutta type
+integration scheme) and it is implemented as a stand-alone library in c++. It
+Useful as input for numerical simulations, as a source of noise for controlling
+experiments using synthetic noise via micro-controllers and for a wide variety
+of applications.
+
+Requirements
+It is a stand-alone library with no dependencies other than the standard
+libraries. Due to it's use of some functions from the <random> library the
+library currently works on c++11 or higher only. This should be OK for most Macs
+and new Linux systems. In some older systems it is possible that you need to add
+`-std=gnu++11` to your compilation flags.
+
+Licence
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef QNOISEFEED_H
+#define QNOISEFEED_H
+
+#include <atomic>
+#include <limits>
+#include <thread>
+#include <vector>
+#include "qNoise.h"
+
+/*
+ * qNoiseFeed is a real-time source of qNoise for a single consumer thread.
+ * A background thread generates the series ahead of demand into a ring of
+ * preallocated blocks (single producer, single consumer, lock-free). The
+ * producer never allocates memory. The consumer takes the samples one by one
+ * from the current block; it only touches the shared indices when it moves to
+ * the next block. tryNext() is wait-free and reports an underrun when no block
+ * is ready; next() waits for the producer instead, and returns NaN if it has
+ * stopped (or was never started) with nothing left in the ring.
+ */
+class qNoiseFeed {
+    qNoiseGen gen;
+    qNoiseParams p;
+    size_t blockSize, blocks;
+    std::vector<double> ring;
+    std::thread producer;
+    std::atomic<bool> running;
+    double eta;
+
+    // Blocks published by the producer and released by the consumer. Each on
+    // its own cache line.
+    alignas(64) std::atomic<size_t> written;
+    alignas(64) std::atomic<size_t> consumed;
+    alignas(64) std::atomic<size_t> underrunCount;
+
+    // Consumer side
+    const double *current;
+    size_t pos, reading;
+    bool holding;
+
+    void produce();
+    bool acquireBlock();
+
+public:
+    qNoiseFeed(const qNoiseParams &p, size_t blockSize = 4096,
+               size_t blocks = 8);
+    ~qNoiseFeed() { stop(); }
+
+    // Generator used by the producer. Seed it or change its backend before
+    // start().
+    qNoiseGen &generator() { return gen; }
+    void start(double eta0 = 0);
+    void stop();
+
+    // Next sample, waiting for the producer if it is behind. NaN (counted as
+    // an underrun) if nothing is ready and the producer is not running.
+    double next() {
+        if (pos == blockSize && !acquireBlock()) {
+            underrunCount.fetch_add(1, std::memory_order_relaxed);
+            while (!acquireBlock()) {
+                // A block published just before stopping is still read
+                if (!running.load(std::memory_order_acquire) && !acquireBlock())
+                    return std::numeric_limits<double>::quiet_NaN();
+                std::this_thread::yield();
+            }
+        }
+        return current[pos++];
+    }
+    // Next sample if there is one ready, false (an underrun) otherwise.
+    bool tryNext(double &x) {
+        if (pos == blockSize && !acquireBlock()) {
+            underrunCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        x = current[pos++];
+        return true;
+    }
+
+    // Samples ready for the consumer, to be called from the consumer thread.
+    size_t depth() const;
+    // Number of times the consumer found no sample ready.
+    size_t underruns() const {
+        return underrunCount.load(std::memory_order_relaxed);
+    }
+    void resetUnderruns() { underrunCount.store(0, std::memory_order_relaxed); }
+};
+
+#endif  // QNOISEFEED_H
@@ -0,0 +1,182 @@
+/*
+qNoise: A generator of non-Gaussian colored noise
+Copyright © 2021, Juan Ignacio Deza
+email: ignacio.deza@uwe.ac.uk
+
+Description
+qNoise is a non-gaussian colored random noise generator. It is a handy source of
+self-correlated noise for a great variety of applications. It depends on two
+parameters only: tau for controlling the autocorrelation, and q for controlling
+the statistics. This noise tends smoothly  for q = 1 to an  Ornstein-Uhlenbeck
+(colored gaussian) noise with autocorrelation tau. for q < 1 it is bounded noise
+and it is supra-Gaussian for q > 1. The noise is generated  via a stochastic
+differential equation using the Heun method (a second order Runge-Kutta type
+integration scheme) and it is implemented as a stand-alone library in c++. It
+Useful as input for numerical simulations, as a source of noise for controlling
+experiments using synthetic noise via micro-controllers and for a wide variety
+of applications.
+
+Requirements
+It is a stand-alone library with no dependencies other than the standard
+libraries. Due to it's use of some functions from the <random> library the
+library currently works on c++11 or higher only. This should be OK for most Macs
+and new Linux systems. In some older systems it is possible that you need to add
+`-std=gnu++11` to your compilation flags.
+
+Licence
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "qNoiseFractional.h"
+#include "qNoiseSpectrum.h"
+
+// Continued fraction of the incomplete beta function (modified Lentz method)
+static double betaFraction(double a, double b, double x) {
+  const double tiny = 1e-300;
+  double c = 1, d = 1 - (a + b) * x / (a + 1);
+  d = 1 / (fabs(d) < tiny ? tiny : d);
+  double h = d;
+  for (int m = 1; m <= 1000; m++) {
+    // Even and odd terms of the fraction
+    for (int odd = 0; odd < 2; odd++) {
+      double num = odd ? -(a + m) * (a + b + m) * x /
+                             ((a + 2 * m) * (a + 2 * m + 1))
+                       : m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m));
+      d = 1 + num * d;
+      d = 1 / (fabs(d) < tiny ? tiny : d);
+      c = 1 + num / c;
+      if (fabs(c) < tiny)
+        c = tiny;
+      h *= d * c;
+    }
+    if (fabs(d * c - 1) < 1e-15)
+      break;
+  }
+  return h;
+}
+
+// Regularized incomplete beta function I_x(a, b)
+static double betaRegularized(double a, double b, double x) {
+  if (x <= 0)
+    return 0;
+  if (x >= 1)
+    return 1;
+  double front = exp(lgamma(a + b) - lgamma(a) - lgamma(b) + a * log(x) +
+                     b * log1p(-x));
+  if (x < (a + 1) / (a + b + 2))
+    return front * betaFraction(a, b, x) / a;
+  return 1 - front * betaFraction(b, a, 1 - x) / b;
+}
+
+/*
+ * The tail probability is monotone in a variable u of (0, hi]; it is solved by
+ * bisection, which keeps the relative precision of the tiny tails.
+ * q<1: x = (1 - 2u) etaCut, tail I_u(a, a) with a = 1/(1-q) + 1.
+ * q>1: Student t with n = (3-q)/(q-1) degrees of freedom,
+ *      t^2 = n (1-u)/u, x = t / sqrt(tau (3-q)), tail I_u(n/2, 1/2) / 2.
+ * q=1: x = u, tail erfc(sqrt(tau) x) / 2.
+ */
+double qNoiseMarginal::upperQuantile(double p, double tau, double q) {
+  // The PDF cannot be normalized, as in qNoiseStationary
+  if (!(q < 3))
+    return std::numeric_limits<double>::quiet_NaN();
+  double lo = 0, hi = q < 1 ? 0.5 : 1;
+  if (q == 1)
+    hi = 40 / sqrt(tau);
+  for (int i = 0; i < 200; i++) {
+    double u = (lo + hi) / 2, tail;
+    if (q < 1)
+      tail = betaRegularized(1 / (1 - q) + 1, 1 / (1 - q) + 1, u);
+    else if (q > 1)
+      tail = betaRegularized((3 - q) / (q - 1) / 2, 0.5, u) / 2;
+    else
+      tail = erfc(sqrt(tau) * u) / 2;
+    // For q=1 the tail decreases with u
+    if ((tail < p) != (q == 1))
+      lo = u;
+    else
+      hi = u;
+  }
+  double u = (lo + hi) / 2;
+  if (q < 1)
+    return (1 - 2 * u) / sqrt(tau * (1 - q));
+  if (q > 1)
+    return sqrt((3 - q) / (q - 1) * (1 - u) / u / (tau * (3 - q)));
+  return u;
+}
+
+qNoiseMarginal::qNoiseMarginal(double tau, double q, size_t points,
+                               double range)
+    : tau(tau), q(q), dz(range / points), table(points + 1) {
+  table[0] = 0;
+  for (size_t i = 1; i <= points; i++) {
+    double z = i * dz;
+    table[i] = q == 1 ? z / sqrt(2 * tau)
+                      : upperQuantile(erfc(z / sqrt(2.0)) / 2, tau, q);
+  }
+}
+
+qNoiseFractional::qNoiseFractional(double hurst, double tau, double q,
+                                   size_t block)
+    : marginal(tau, q), amplitude(2 * block), work(2 * block),
+      draws(4 * block), pending(2 * block), pos(2 * block) {
+  // First row of the circulant matrix: the autocovariance of the fractional
+  // Gaussian noise up to lag block, and back.
+  size_t m = 2 * block;
+  double h2 = 2 * hurst;
+  for (size_t k = 0; k < m; k++) {
+    double j = double(std::min(k, m - k));
+    work[k] = 0.5 * (pow(j + 1, h2) - 2 * pow(j, h2) + pow(fabs(j - 1), h2));
+  }
+  // Its eigenvalues, non negative for the fractional Gaussian noise
+  qNoiseFFT(work.data(), m);
+  for (size_t k = 0; k < m; k++)
+    amplitude[k] = sqrt(std::max(0.0, work[k].real()) / m);
+}
+
+// Two new blocks from one FFT of complex Gaussian draws.
+void qNoiseFractional::nextBlocks() {
+  size_t m = amplitude.size();
+  gen.gaussWN(draws.data(), 2 * m);
+  for (size_t k = 0; k < m; k++)
+    work[k] = amplitude[k] * std::complex<double>(draws[2 * k],
+                                                  draws[2 * k + 1]);
+  qNoiseFFT(work.data(), m);
+  for (size_t i = 0; i < m / 2; i++) {
+    pending[i] = work[i].real();
+    pending[m / 2 + i] = work[i].imag();
+  }
+  pos = 0;
+}
+
+void qNoiseFractional::gaussian(double *out, size_t n) {
+  size_t i = 0;
+  while (i < n) {
+    if (pos == pending.size())
+      nextBlocks();
+    size_t size = std::min(n - i, pending.size() - pos);
+    std::copy(pending.begin() + pos, pending.begin() + pos + size, out + i);
+    pos += size;
+    i += size;
+  }
+}
+
+void qNoiseFractional::generate(double *out, size_t n) {
+  gaussian(out, n);
+  for (size_t i = 0; i < n; i++)
+    out[i] = marginal(out[i]);
+}
@@ -0,0 +1,130 @@
+/*
+qNoise: A generator of non-Gaussian colored noise
+Copyright © 2021, Juan Ignacio Deza
+email: ignacio.deza@uwe.ac.uk
+
+Description
+qNoise is a non-gaussian colored random noise generator. It is a handy source of
+self-correlated noise for a great variety of applications. It depends on two
+parameters only: tau for controlling the autocorrelation, and q for controlling
+the statistics. This noise tends smoothly  for q = 1 to an  Ornstein-Uhlenbeck
+(colored gaussian) noise with autocorrelation tau. for q < 1 it is bounded noise
+and it is supra-Gaussian for q > 1. The noise is generated  via a stochastic
+differential equation using the Heun method (a second order Runge-Kutta type
+integration scheme) and it is implemented as a stand-alone library in c++. It
+Useful as input for numerical simulations, as a source of noise for controlling
+experiments using synthetic noise via micro-controllers and for a wide variety
+of applications.
+
+Requirements
+It is a stand-alone library with no dependencies other than the standard
+libraries. Due to it's use of some functions from the <random> library the
+library currently works on c++11 or higher only. This should be OK for most Macs
+and new Linux systems. In some older systems it is possible that you need to add
+`-std=gnu++11` to your compilation flags.
+
+Licence
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef QNOISEFRACTIONAL_H
+#define QNOISEFRACTIONAL_H
+
+#include <complex>
+#include <vector>
+#include "qNoise.h"
+
+/*
+ * Monotone map of a standard Gaussian variate to the stationary PDF of
+ * qNoise, P(x) ~ (1 - tau (1-q) x^2)^(1/(1-q)) (the PDF of the unit tests).
+ * For q<1 it is a symmetric Beta distribution scaled to (-etaCut, etaCut),
+ * for q>1 a Student t with (3-q)/(q-1) degrees of freedom, so q<3. Both
+ * quantiles are tabulated once, solving the regularized incomplete beta
+ * function, for Gaussian values up to `range`; the map interpolates the table
+ * linearly and beyond it extends the last slope. For q>=3 the PDF cannot be
+ * normalized: valid() is false and the map returns NaN, as qNoiseStationary.
+ */
+class qNoiseMarginal {
+    double tau, q;
+    double dz;
+    std::vector<double> table;  // x at z = i * dz, i >= 0; odd in z
+
+public:
+    qNoiseMarginal(double tau, double q, size_t points = 4096,
+                   double range = 8);
+    double operator()(double z) const {
+        double a = fabs(z) / dz, x;
+        size_t i = size_t(a);
+        if (i + 1 < table.size())
+            x = table[i] + (a - i) * (table[i + 1] - table[i]);
+        else {
+            size_t n = table.size() - 1;
+            x = table[n] + (a - n) * (table[n] - table[n - 1]);
+        }
+        return z < 0 ? -x : x;
+    }
+    bool valid() const { return q < 3; }
+    // Quantile of the PDF at the upper tail probability p (0 < p <= 1/2)
+    static double upperQuantile(double p, double tau, double q);
+};
+
+/*
+ * qNoiseFractional generates long-memory noise with the marginal PDF of
+ * qNoise. A fractional Gaussian noise of Hurst exponent hurst, with
+ * autocorrelation 0.5 (|k+1|^2h - 2|k|^2h + |k-1|^2h) ~ h (2h-1) k^(2h-2),
+ * is generated by circulant embedding in O(N log N): for blocks of `block`
+ * samples (a power of 2) the eigenvalues of the circulant matrix of size
+ * 2 block are computed once, and each FFT of 2 block Gaussian draws gives two
+ * independent blocks (real and imaginary parts). Each value is then mapped
+ * by qNoiseMarginal, which keeps the long memory (the map is odd, so the
+ * correlation decays with the same exponent, only slightly smaller).
+ * The correlation is exact within a block and blocks are independent, so the
+ * memory is cut at `block` samples: a series of any length is generated
+ * block by block in O(block) memory (about 96 bytes per sample of the block:
+ * the eigenvalues, the FFT, the draws and the pending values), and
+ * a block at least as long as the series gives it exactly.
+ */
+class qNoiseFractional {
+    qNoiseGen gen;
+    qNoiseMarginal marginal;
+    std::vector<double> amplitude;  // sqrt(eigenvalue / (2 block))
+    std::vector<std::complex<double> > work;
+    std::vector<double> draws, pending;
+    size_t pos;
+
+    void nextBlocks();
+
+public:
+    qNoiseFractional(double hurst, double tau, double q,
+                     size_t block = 1 << 20);
+
+    // Seeding discards the values left of the current blocks
+    void seedManual(unsigned UserSeed) {
+        gen.seedManual(UserSeed);
+        pos = pending.size();
+    }
+    void seedTimer() {
+        gen.seedTimer();
+        pos = pending.size();
+    }
+    size_t block() const { return amplitude.size() / 2; }
+    // False for q>=3, whose values are NaN (see qNoiseMarginal)
+    bool valid() const { return marginal.valid(); }
+    // Next n values of the fractional Gaussian noise, unit variance
+    void gaussian(double *out, size_t n);
+    // Next n values of the noise with the marginal PDF of qNoise
+    void generate(double *out, size_t n);
+};
+
+#endif  // QNOISEFRACTIONAL_H
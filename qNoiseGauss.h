@@ -0,0 +1,292 @@
+/*
+qNoise: A generator of non-Gaussian colored noise
+Copyright © 2021, Juan Ignacio Deza
+email: ignacio.deza@uwe.ac.uk
+
+Description
+qNoise is a non-gaussian colored random noise generator. It is a handy source of
+self-correlated noise for a great variety of applications. It depends on two
+parameters only: tau for controlling the autocorrelation, and q for controlling
+the statistics. This noise tends smoothly  for q = 1 to an  Ornstein-Uhlenbeck
+(colored gaussian) noise with autocorrelation tau. for q < 1 it is bounded noise
+and it is supra-Gaussian for q > 1. The noise is generated  via a stochastic
+differential equation using the Heun method (a second order Runge-Kutta type
+integration scheme) and it is implemented as a stand-alone library in c++. It
+Useful as input for numerical simulations, as a source of noise for controlling
+experiments using synthetic noise via micro-controllers and for a wide variety
+of applications.
+
+Requirements
+It is a stand-alone library with no dependencies other than the standard
+libraries. Due to it's use of some functions from the <random> library the
+library currently works on c++11 or higher only. This should be OK for most Macs
+and new Linux systems. In some older systems it is possible that you need to add
+`-std=gnu++11` to your compilation flags.
+
+Licence
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef QNOISEGAUSS_H
+#define QNOISEGAUSS_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <limits>
+
+/*
+ * xoshiro256++ (Blackman & Vigna). A small and fast 64 bit generator that
+ * satisfies UniformRandomBitGenerator. It is seeded from a single integer
+ * expanded with splitmix64.
+ */
+class xoshiro256pp {
+    uint64_t s[4];
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    void jumpWith(uint64_t j0, uint64_t j1, uint64_t j2, uint64_t j3) {
+        const uint64_t jumpPoly[] = {j0, j1, j2, j3};
+        uint64_t t[4] = {0, 0, 0, 0};
+        for (int i = 0; i < 4; i++)
+            for (int b = 0; b < 64; b++) {
+                if (jumpPoly[i] & (uint64_t(1) << b))
+                    for (int k = 0; k < 4; k++)
+                        t[k] ^= s[k];
+                (*this)();
+            }
+        for (int k = 0; k < 4; k++)
+            s[k] = t[k];
+    }
+
+public:
+    typedef uint64_t result_type;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    explicit xoshiro256pp(uint64_t seed = 0) { this->seed(seed); }
+
+    void seed(uint64_t seed) {
+        for (int i = 0; i < 4; i++) {
+            uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            s[i] = z ^ (z >> 31);
+        }
+    }
+
+    // Advance 2^128 draws. Used to split the sequence in non-overlapping
+    // streams.
+    void jump() { jumpWith(0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                           0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL); }
+    // Advance 2^192 draws, that is 2^64 streams of jump().
+    void longJump() { jumpWith(0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL,
+                               0x77710069854ee241ULL, 0x39109bb02acbe635ULL); }
+
+    friend std::ostream &operator<<(std::ostream &os, const xoshiro256pp &e) {
+        return os << e.s[0] << ' ' << e.s[1] << ' ' << e.s[2] << ' ' << e.s[3];
+    }
+    friend std::istream &operator>>(std::istream &is, xoshiro256pp &e) {
+        return is >> e.s[0] >> e.s[1] >> e.s[2] >> e.s[3];
+    }
+
+    result_type operator()() {
+        uint64_t result = rotl(s[0] + s[3], 23) + s[0];
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+};
+
+/*
+ * Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2,
+ * 3"). A counter-based generator: block k of four 32 bit words is a function
+ * of the key and k only, so the state is a few words and any position of the
+ * sequence can be reached in O(1) with discard or seek.
+ * normal() returns the Gaussian variate of a whole block (Box-Muller), so the
+ * i-th block always gives the same variate whatever was drawn before.
+ */
+class philox4x32 {
+    uint32_t key[2];
+    uint64_t ctr;      // next block to generate
+    uint32_t out[4];   // current block
+    unsigned idx;      // next word of the current block, 4 when used up
+
+    static uint32_t mulhilo(uint32_t a, uint32_t b, uint32_t &hi) {
+        uint64_t product = uint64_t(a) * b;
+        hi = uint32_t(product >> 32);
+        return uint32_t(product);
+    }
+
+    void block(uint64_t k, uint32_t *r) const {
+        uint32_t c[4] = {uint32_t(k), uint32_t(k >> 32), 0, 0};
+        uint32_t k0 = key[0], k1 = key[1];
+        for (int round = 0; round < 10; round++) {
+            uint32_t hi0, hi1;
+            uint32_t lo0 = mulhilo(0xD2511F53u, c[0], hi0);
+            uint32_t lo1 = mulhilo(0xCD9E8D57u, c[2], hi1);
+            uint32_t n0 = hi1 ^ c[1] ^ k0, n2 = hi0 ^ c[3] ^ k1;
+            c[0] = n0;
+            c[1] = lo1;
+            c[2] = n2;
+            c[3] = lo0;
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+        for (int i = 0; i < 4; i++)
+            r[i] = c[i];
+    }
+
+public:
+    typedef uint32_t result_type;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    explicit philox4x32(uint64_t seed = 0) { this->seed(seed); }
+
+    void seed(uint64_t seed) {
+        key[0] = uint32_t(seed);
+        key[1] = uint32_t(seed >> 32);
+        ctr = 0;
+        idx = 4;
+    }
+
+    result_type operator()() {
+        if (idx == 4) {
+            block(ctr++, out);
+            idx = 0;
+        }
+        return out[idx++];
+    }
+
+    // Skip z words in O(1).
+    void discard(unsigned long long z) {
+        for (; idx < 4 && z > 0; z--)
+            idx++;
+        ctr += z / 4;
+        if (z % 4) {
+            block(ctr++, out);
+            idx = z % 4;
+        }
+    }
+
+    // Position in blocks: seek(tell()) continues with the next whole block.
+    uint64_t tell() const { return ctr; }
+    void seek(uint64_t k) {
+        ctr = k;
+        idx = 4;
+    }
+
+    // Standard normal variate from the next whole block.
+    double normal() {
+        uint32_t r[4];
+        block(ctr++, r);
+        idx = 4;
+        const double scale = 1.0 / 9007199254740992.0;
+        double u1 = (((uint64_t(r[0]) << 32 | r[1]) >> 11) + 1) * scale;
+        double u2 = ((uint64_t(r[2]) << 32 | r[3]) >> 11) * scale;
+        return sqrt(-2 * log(u1)) * cos(6.283185307179586 * u2);
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const philox4x32 &e) {
+        return os << e.key[0] << ' ' << e.key[1] << ' ' << e.ctr << ' ' << e.idx;
+    }
+    friend std::istream &operator>>(std::istream &is, philox4x32 &e) {
+        is >> e.key[0] >> e.key[1] >> e.ctr >> e.idx;
+        if (e.idx < 4)
+            e.block(e.ctr - 1, e.out);
+        return is;
+    }
+};
+
+/*
+ * Ziggurat sampler of the standard normal distribution (Marsaglia & Tsang,
+ * 256 layers). Almost every draw costs one 64 bit integer and a comparison
+ * against a table: the low 8 bits choose the layer and the high 53 bits the
+ * position inside it. The engine must return 64 random bits.
+ */
+class zigguratNormal {
+    struct tables {
+        double x[257], f[257];
+        tables() {
+            const double R = 3.6541528853610088, V = 0.00492867323399;
+            x[0] = V / exp(-R * R / 2);
+            x[1] = R;
+            for (int i = 2; i < 256; i++)
+                x[i] = sqrt(-2 * log(V / x[i - 1] + exp(-x[i - 1] * x[i - 1] / 2)));
+            x[256] = 0;
+            for (int i = 0; i < 257; i++)
+                f[i] = exp(-x[i] * x[i] / 2);
+        }
+    };
+    static const tables &table() {
+        static const tables t;
+        return t;
+    }
+    const tables &t;
+
+    // Uniform in [0,1) and (0,1] from the 53 high bits of a 64 bit integer.
+    static double unit(uint64_t bits) {
+        return (bits >> 11) * (1.0 / 9007199254740992.0);
+    }
+    static double unitOpen(uint64_t bits) {
+        return ((bits >> 11) + 1) * (1.0 / 9007199254740992.0);
+    }
+
+public:
+    zigguratNormal() : t(table()) {}
+    zigguratNormal(const zigguratNormal &) : t(table()) {}
+    zigguratNormal &operator=(const zigguratNormal &) { return *this; }
+
+    template <class Engine> double operator()(Engine &rng) {
+        const double R = 3.6541528853610088;
+        while (1) {
+            uint64_t bits = rng();
+            int i = bits & 0xff;
+            double x = (2 * unit(bits) - 1) * t.x[i];
+            if (fabs(x) < t.x[i + 1])
+                return x;
+            if (i == 0) {
+                // Tail of the distribution, beyond R
+                double xt, y;
+                do {
+                    xt = log(unitOpen(rng())) / R;
+                    y = log(unitOpen(rng()));
+                } while (-2 * y < xt * xt);
+                return (x < 0) ? xt - R : R - xt;
+            }
+            if (t.f[i + 1] + (t.f[i] - t.f[i + 1]) * unit(rng()) < exp(-x * x / 2))
+                return x;
+        }
+    }
+
+    // Fill a block with n independent draws.
+    template <class Engine> void fill(Engine &rng, double *out, size_t n) {
+        for (size_t i = 0; i < n; i++)
+            out[i] = (*this)(rng);
+    }
+};
+
+#endif  // QNOISEGAUSS_H
@@ -0,0 +1,243 @@
+/*
+qNoise: A generator of non-Gaussian colored noise
+Copyright © 2021, Juan Ignacio Deza
+email: ignacio.deza@uwe.ac.uk
+
+Description
+qNoise is a non-gaussian colored random noise generator. It is a handy source of
+self-correlated noise for a great variety of applications. It depends on two
+parameters only: tau for controlling the autocorrelation, and q for controlling
+the statistics. This noise tends smoothly  for q = 1 to an  Ornstein-Uhlenbeck
+(colored gaussian) noise with autocorrelation tau. for q < 1 it is bounded noise
+and it is supra-Gaussian for q > 1. The noise is generated  via a stochastic
+differential equation using the Heun method (a second order Runge-Kutta type
+integration scheme) and it is implemented as a stand-alone library in c++. It
+Useful as input for numerical simulations, as a source of noise for controlling
+experiments using synthetic noise via micro-controllers and for a wide variety
+of applications.
+
+Requirements
+It is a stand-alone library with no dependencies other than the standard
+libraries. Due to it's use of some functions from the <random> library the
+library currently works on c++11 or higher only. This should be OK for most Macs
+and new Linux systems. In some older systems it is possible that you need to add
+`-std=gnu++11` to your compilation flags.
+
+Licence
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <utility>
+#include "qNoiseIO.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define QNOISE_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool parseFormat(const std::string &name, qNoiseFormat &format) {
+  const char *names[] = {"txt", "f64", "f32", "npy", "npy32", "map"};
+  for (int i = 0; i < 6; i++)
+    if (name == names[i]) {
+      format = qNoiseFormat(i);
+      return true;
+    }
+  return false;
+}
+
+const char *formatExtension(qNoiseFormat format) {
+  const char *extensions[] = {"txt", "f64", "f32", "npy", "npy", "map"};
+  return extensions[format];
+}
+
+size_t formatSampleSize(qNoiseFormat format) {
+  switch (format) {
+  case FORMAT_F64:
+  case FORMAT_NPY:
+  case FORMAT_MAP:
+    return 8;
+  case FORMAT_F32:
+  case FORMAT_NPY32:
+    return 4;
+  default:
+    return 0;
+  }
+}
+
+/*
+ * NumPy format 1.0: magic string, version, length of the header as a little
+ * endian uint16 and a python dict padded with spaces so that the data starts
+ * at a multiple of 64 bytes.
+ */
+std::string npyHeader(size_t n, bool single) {
+  std::ostringstream dict;
+  dict << "{'descr': '" << (single ? "<f4" : "<f8")
+       << "', 'fortran_order': False, 'shape': (" << n << ",), }";
+  std::string d = dict.str();
+  size_t total = 10 + d.size() + 1;
+  d.append((64 - total % 64) % 64, ' ');
+  d += '\n';
+  std::string header("\x93NUMPY\x01\x00", 8);
+  header += char(d.size() & 0xff);
+  header += char(d.size() >> 8);
+  return header + d;
+}
+
+// True if the host stores numbers as little endian.
+static bool littleEndian() {
+  uint16_t one = 1;
+  unsigned char first;
+  memcpy(&first, &one, 1);
+  return first == 1;
+}
+
+// Copy a value to out as little endian.
+template <class T> static void storeLittleEndian(T value, char *out) {
+  memcpy(out, &value, sizeof(T));
+  if (!littleEndian())
+    for (size_t i = 0; i < sizeof(T) / 2; i++)
+      std::swap(out[i], out[sizeof(T) - 1 - i]);
+}
+
+void qNoiseWriter::header(size_t n) {
+  if (format == FORMAT_NPY || format == FORMAT_NPY32)
+    os << npyHeader(n, format == FORMAT_NPY32);
+}
+
+template <class T> void qNoiseWriter::writeSamples(const T *x, size_t n) {
+  size_t size = formatSampleSize(format);
+  if (size == 0) {
+    for (size_t i = 0; i < n; i++)
+      os << x[i] << '\n';
+    return;
+  }
+  buffer.resize(n * size);
+  if (size == 8)
+    for (size_t i = 0; i < n; i++)
+      storeLittleEndian(double(x[i]), &buffer[i * 8]);
+  else
+    for (size_t i = 0; i < n; i++)
+      storeLittleEndian(float(x[i]), &buffer[i * 4]);
+  os.write(buffer.data(), buffer.size());
+}
+
+void qNoiseWriter::write(const double *x, size_t n) { writeSamples(x, n); }
+
+void qNoiseWriter::write(const float *x, size_t n) { writeSamples(x, n); }
+
+bool qNoiseMap::open(const std::string &fileName, size_t size) {
+  close();
+#ifdef QNOISE_HAVE_MMAP
+  fd = ::open(fileName.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd < 0)
+    return false;
+  // Only grown: the samples after the first size ones are kept
+  struct stat info;
+  if (fstat(fd, &info) != 0 ||
+      (size_t(info.st_size) < size * sizeof(double) &&
+       ftruncate(fd, off_t(size * sizeof(double))) != 0)) {
+    close();
+    return false;
+  }
+  n = size;
+  if (n == 0)
+    return true;
+  void *m = mmap(0, n * sizeof(double), PROT_READ | PROT_WRITE, MAP_SHARED,
+                 fd, 0);
+  if (m == MAP_FAILED) {
+    close();
+    return false;
+  }
+  map = static_cast<double *>(m);
+  writable = true;
+  // The series is written once from beginning to end
+  madvise(m, n * sizeof(double), MADV_SEQUENTIAL);
+  return true;
+#else
+  (void)fileName;
+  (void)size;
+  return false;
+#endif
+}
+
+bool qNoiseMap::openRead(const std::string &fileName, size_t size) {
+  close();
+#ifdef QNOISE_HAVE_MMAP
+  fd = ::open(fileName.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat info;
+  if (fstat(fd, &info) != 0 ||
+      size_t(info.st_size) < size * sizeof(double)) {
+    close();
+    return false;
+  }
+  n = size;
+  if (n == 0)
+    return true;
+  void *m = mmap(0, n * sizeof(double), PROT_READ, MAP_SHARED, fd, 0);
+  if (m == MAP_FAILED) {
+    close();
+    return false;
+  }
+  map = static_cast<double *>(m);
+  return true;
+#else
+  (void)fileName;
+  (void)size;
+  return false;
+#endif
+}
+
+void qNoiseMap::close() {
+#ifdef QNOISE_HAVE_MMAP
+  if (map)
+    munmap(map, n * sizeof(double));
+  if (fd >= 0)
+    ::close(fd);
+#endif
+  fd = -1;
+  map = 0;
+  n = 0;
+  writable = false;
+}
+
+bool qNoiseCheckpoint::save(const std::string &fileName) const {
+  std::ofstream file(fileName);
+  file.precision(17);
+  file << "qNoise checkpoint 1\n"
+       << tau << ' ' << q << ' ' << H << ' ' << n << ' ' << eta << '\n'
+       << state;
+  return bool(file);
+}
+
+bool qNoiseCheckpoint::load(const std::string &fileName) {
+  std::ifstream file(fileName);
+  std::string line;
+  if (!std::getline(file, line) || line != "qNoise checkpoint 1")
+    return false;
+  file >> tau >> q >> H >> n >> eta;
+  file.ignore(1);
+  if (!std::getline(file, state))
+    return false;
+  state += '\n';
+  return true;
+}
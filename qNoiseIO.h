@@ -0,0 +1,147 @@
+/*
+qNoise: A generator of non-Gaussian colored noise
+Copyright © 2021, Juan Ignacio Deza
+email: ignacio.deza@uwe.ac.uk
+
+Description
+qNoise is a non-gaussian colored random noise generator. It is a handy source of
+self-correlated noise for a great variety of applications. It depends on two
+parameters only: tau for controlling the autocorrelation, and q for controlling
+the statistics. This noise tends smoothly  for q = 1 to an  Ornstein-Uhlenbeck
+(colored gaussian) noise with autocorrelation tau. for q < 1 it is bounded noise
+and it is supra-Gaussian for q > 1. The noise is generated  via a stochastic
+differential equation using the Heun method (a second order Runge-Kutta type
+integration scheme) and it is implemented as a stand-alone library in c++. It
+Useful as input for numerical simulations, as a source of noise for controlling
+experiments using synthetic noise via micro-controllers and for a wide variety
+of applications.
+
+Requirements
+It is a stand-alone library with no dependencies other than the standard
+libraries. Due to it's use of some functions from the <random> library the
+library currently works on c++11 or higher only. This should be OK for most Macs
+and new Linux systems. In some older systems it is possible that you need to add
+`-std=gnu++11` to your compilation flags.
+
+Licence
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef QNOISEIO_H
+#define QNOISEIO_H
+
+#include <cassert>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+ * Output formats of a series.
+ * FORMAT_TXT: one value per line, as text.
+ * FORMAT_F64, FORMAT_F32: raw little-endian float64 or float32.
+ * FORMAT_NPY, FORMAT_NPY32: the same with a .npy header (NumPy format 1.0),
+ * readable with numpy.load.
+ * FORMAT_MAP: raw float64 written through a memory mapping (qNoiseMap), with a
+ * checkpoint to continue the series later. The values are in the byte order
+ * of the host, not always little-endian, so its files are named ".map".
+ */
+enum qNoiseFormat {
+    FORMAT_TXT,
+    FORMAT_F64,
+    FORMAT_F32,
+    FORMAT_NPY,
+    FORMAT_NPY32,
+    FORMAT_MAP
+};
+
+// Format from its name (txt, f64, f32, npy, npy32, map), false if unknown.
+bool parseFormat(const std::string &name, qNoiseFormat &format);
+// Usual file extension of the format.
+const char *formatExtension(qNoiseFormat format);
+// Bytes per sample of the binary formats, 0 for text.
+size_t formatSampleSize(qNoiseFormat format);
+// Header of a .npy file with n samples of float64 (or float32 if single).
+std::string npyHeader(size_t n, bool single);
+
+/*
+ * Writes series to a stream in one of the formats above. The samples of each
+ * call are converted in an internal buffer and written with a single call,
+ * and text is written without flushing on every line.
+ */
+class qNoiseWriter {
+    std::ostream &os;
+    qNoiseFormat format;
+    std::vector<char> buffer;
+    template <class T> void writeSamples(const T *x, size_t n);
+
+public:
+    qNoiseWriter(std::ostream &os, qNoiseFormat format)
+        : os(os), format(format) {}
+    // Write the .npy header if the format has one; n is the total of samples.
+    void header(size_t n);
+    void write(const double *x, size_t n);
+    // Series generated in float32; written as float64 if the format is.
+    void write(const float *x, size_t n);
+};
+
+/*
+ * Output file of raw float64 samples mapped in memory, so that the batch
+ * functions of qNoiseGen write the series directly in the file. The samples
+ * are in the byte order of the host. open() creates the file or grows it to
+ * n samples keeping what it had, which allows to extend a series, and maps
+ * its first n samples; a longer file is never shortened. openRead()
+ * maps the first n samples of an existing file read only, without copying
+ * them: its samples can be read with data() but not written (writableData()
+ * is only for open()). Only available on POSIX systems.
+ */
+class qNoiseMap {
+    int fd;
+    double *map;
+    size_t n;
+    bool writable;
+
+public:
+    qNoiseMap() : fd(-1), map(0), n(0), writable(false) {}
+    ~qNoiseMap() { close(); }
+    // It owns the mapping and the file, so it cannot be copied
+    qNoiseMap(const qNoiseMap &) = delete;
+    qNoiseMap &operator=(const qNoiseMap &) = delete;
+    bool open(const std::string &fileName, size_t n);
+    bool openRead(const std::string &fileName, size_t n);
+    void close();
+    const double *data() const { return map; }
+    double *writableData() {
+        assert(writable || !map);
+        return map;
+    }
+    size_t size() const { return n; }
+};
+
+/*
+ * Checkpoint of a series: parameters, number of samples written, last value
+ * of the noise and state of the generator (see qNoiseGenT::saveState). It is
+ * saved as a small text file next to the series.
+ */
+struct qNoiseCheckpoint {
+    double tau, q, H;
+    size_t n;
+    double eta;
+    std::string state;
+
+    bool save(const std::string &fileName) const;
+    bool load(const std::string &fileName);
+};
+
+#endif  // QNOISEIO_H
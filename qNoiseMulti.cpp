@@ -0,0 +1,235 @@
+/*
+qNoise: A generator of non-Gaussian colored noise
+Copyright © 2021, Juan Ignacio Deza
+email: ignacio.deza@uwe.ac.uk
+
+Description
+qNoise is a non-gaussian colored random noise generator. It is a handy source of
+self-correlated noise for a great variety of applications. It depends on two
+parameters only: tau for controlling the autocorrelation, and q for controlling
+the statistics. This noise tends smoothly  for q = 1 to an  Ornstein-Uhlenbeck
+(colored gaussian) noise with autocorrelation tau. for q < 1 it is bounded noise
+and it is supra-Gaussian for q > 1. The noise is generated  via a stochastic
+differential equation using the Heun method (a second order Runge-Kutta type
+integration scheme) and it is implemented as a stand-alone library in c++. It
+Useful as input for numerical simulations, as a source of noise for controlling
+experiments using synthetic noise via micro-controllers and for a wide variety
+of applications.
+
+Requirements
+It is a stand-alone library with no dependencies other than the standard
+libraries. Due to it's use of some functions from the <random> library the
+library currently works on c++11 or higher only. This should be OK for most Macs
+and new Linux systems. In some older systems it is possible that you need to add
+`-std=gnu++11` to your compilation flags.
+
+Licence
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Without contraction into FMA, as qNoise.cpp, so that the lanes round as the
+// scalar steps, and without trapping math, which only keeps the selects of
+// the implicit step from becoming blends (the results are the same). They
+// are set before the headers so that the kernels of qNoiseCore.h can be
+// inlined.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC optimize("fp-contract=off", "no-trapping-math")
+#elif defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#endif
+
+// The Heun kernel is compiled for several instruction sets, chosen at run time.
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && \
+    defined(__linux__)
+#define QNOISE_TARGET_CLONES \
+  __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define QNOISE_TARGET_CLONES
+#endif
+
+#include "qNoiseMulti.h"
+
+/*
+ * One Heun step of n paths, without the check of the bounds. It uses the same
+ * expressions as qNoiseGen::heunStep so that a path inside the bounds gets
+ * the same value as with qNoise given the same Gaussian draw.
+ */
+QNOISE_TARGET_CLONES
+static void heunLanes(const double *eta, const double *noise, double *next,
+                      size_t n, double H, double sqrt_H, double invTau,
+                      double tauQm1) {
+  for (size_t i = 0; i < n; i++) {
+    double x = eta[i];
+    double drift = x / (1 + x * x * tauQm1) * invTau;
+    double kHeun = H * drift;
+    double lHeun = sqrt_H * noise[i] * invTau;
+    double pred = x + kHeun + lHeun;
+    double differential =
+        -H / 2 * (drift + pred / (1 + pred * pred * tauQm1) * invTau) + lHeun;
+    next[i] = x + differential;
+  }
+}
+
+/*
+ * Step of n paths for q>1, as qNoiseGenT::unboundedStep.
+ */
+QNOISE_TARGET_CLONES
+static void unboundedLanes(const double *eta, const double *noise,
+                           double *next, size_t n, double driftH,
+                           double noiseH, double tauQm1) {
+  for (size_t i = 0; i < n; i++)
+    next[i] = qnoise::heun(eta[i], noise[i], driftH, noiseH, tauQm1);
+}
+
+/*
+ * Exact Ornstein-Uhlenbeck update of n paths for q=1.
+ */
+QNOISE_TARGET_CLONES
+static void exactLanes(const double *eta, const double *noise, double *next,
+                       size_t n, double decay, double diffusion) {
+  for (size_t i = 0; i < n; i++)
+    next[i] = qnoise::exact(eta[i], noise[i], decay, diffusion);
+}
+
+/*
+ * Rejection-free step of n paths for q<1, as qNoiseGenT::boundedStep.
+ */
+QNOISE_TARGET_CLONES
+static void boundedLanes(const double *eta, const double *noise, double *next,
+                         size_t n, double driftH, double noiseH, double tauQm1,
+                         double etaCut) {
+  for (size_t i = 0; i < n; i++)
+    next[i] = qnoise::implicit(eta[i], noise[i], driftH, noiseH, tauQm1,
+                               etaCut);
+}
+
+/*
+ * Mix the Gaussian draws g of n paths by the lower triangular matrix L
+ * (column major): noise = L g, one axpy per column.
+ */
+QNOISE_TARGET_CLONES
+static void mixLanes(const double *L, const double *g, double *noise,
+                     size_t n) {
+  for (size_t i = 0; i < n; i++)
+    noise[i] = L[i] * g[0];
+  for (size_t j = 1; j < n; j++) {
+    const double *column = L + j * n;
+    double gj = g[j];
+    for (size_t i = j; i < n; i++)
+      noise[i] += column[i] * gj;
+  }
+}
+
+qNoiseMulti::qNoiseMulti(size_t paths, double tau, double q, double H)
+    : p(tau, q, H), eta(paths, 0.0), next(paths), noise(paths) {
+  gen.setGaussBackend(qNoiseGen::GAUSS_ZIGGURAT);
+  outOfBounds.reserve(paths);
+}
+
+qNoiseMulti::qNoiseMulti(size_t paths, const qNoiseParams &p)
+    : p(p), eta(paths, 0.0), next(paths), noise(paths) {
+  gen.setGaussBackend(qNoiseGen::GAUSS_ZIGGURAT);
+  outOfBounds.reserve(paths);
+}
+
+bool qNoiseMulti::setCorrelation(const std::vector<double> &correlation) {
+  size_t n = eta.size();
+  if (correlation.empty()) {
+    mixing.clear();
+    return true;
+  }
+  if (correlation.size() != n * n) {
+    mixing.clear();
+    return false;
+  }
+  // Cholesky decomposition, L[j * n + i] is the row i and column j
+  std::vector<double> L(n * n, 0.0);
+  for (size_t j = 0; j < n; j++) {
+    double diagonal = correlation[j * n + j];
+    for (size_t k = 0; k < j; k++)
+      diagonal -= L[k * n + j] * L[k * n + j];
+    if (!(diagonal > 0)) {
+      mixing.clear();
+      return false;
+    }
+    L[j * n + j] = sqrt(diagonal);
+    for (size_t i = j + 1; i < n; i++) {
+      double sum = correlation[i * n + j];
+      for (size_t k = 0; k < j; k++)
+        sum -= L[k * n + i] * L[k * n + j];
+      L[j * n + i] = sum / L[j * n + j];
+    }
+  }
+  mixing.swap(L);
+  draws.resize(n);
+  return true;
+}
+
+const double *qNoiseMulti::step() {
+  size_t n = eta.size();
+  if (mixing.empty())
+    gen.gaussWN(noise.data(), n);
+  else {
+    gen.gaussWN(draws.data(), n);
+    mixLanes(mixing.data(), draws.data(), noise.data(), n);
+  }
+  if (p.regime == QNOISE_GAUSSIAN) {
+    exactLanes(eta.data(), noise.data(), next.data(), n, p.decay, p.diffusion);
+    QNOISE_COUNT(gen.stats.attempts[0] += n);
+    eta.swap(next);
+    return eta.data();
+  }
+  if (p.regime == QNOISE_UNBOUNDED) {
+    unboundedLanes(eta.data(), noise.data(), next.data(), n, p.driftH,
+                   p.noiseH, p.tauQm1);
+    QNOISE_COUNT(gen.stats.attempts[0] += n);
+    eta.swap(next);
+    return eta.data();
+  }
+  if (gen.bounded == qNoiseGen::BOUNDED_IMPLICIT) {
+    boundedLanes(eta.data(), noise.data(), next.data(), n, p.driftH, p.noiseH,
+                 p.tauQm1, p.etaCut);
+    QNOISE_COUNT(gen.stats.attempts[0] += n);
+    eta.swap(next);
+    return eta.data();
+  }
+  heunLanes(eta.data(), noise.data(), next.data(), n, p.H, p.sqrt_H, p.invTau,
+            p.tauQm1);
+  // Lane compaction: collect the paths out of bounds
+  outOfBounds.clear();
+  double etaCut = p.etaCut;
+  for (size_t i = 0; i < n; i++)
+    if ((fabs(next[i]) > etaCut) || std::isnan(next[i]))
+      outOfBounds.push_back(i);
+  // and retry them with the scalar step, counting the attempt already done.
+  QNOISE_COUNT(gen.stats.attempts[0] += n - outOfBounds.size());
+  for (size_t k = 0; k < outOfBounds.size(); k++) {
+    size_t i = outOfBounds[k];
+    next[i] = gen.retryStep(eta[i], p);
+  }
+  eta.swap(next);
+  return eta.data();
+}
+
+void qNoiseMulti::qNoise(double *out, size_t steps, qNoiseLayout layout) {
+  size_t n = eta.size();
+  for (size_t s = 0; s < steps; s++) {
+    const double *x = step();
+    if (layout == LAYOUT_INTERLEAVED)
+      std::copy(x, x + n, out + s * n);
+    else
+      for (size_t i = 0; i < n; i++)
+        out[i * steps + s] = x[i];
+  }
+}
@@ -0,0 +1,130 @@
+/*
+qNoise: A generator of non-Gaussian colored noise
+Copyright © 2021, Juan Ignacio Deza
+email: ignacio.deza@uwe.ac.uk
+
+Description
+qNoise is a non-gaussian colored random noise generator. It is a handy source of
+self-correlated noise for a great variety of applications. It depends on two
+parameters only: tau for controlling the autocorrelation, and q for controlling
+the statistics. This noise tends smoothly  for q = 1 to an  Ornstein-Uhlenbeck
+(colored gaussian) noise with autocorrelation tau. for q < 1 it is bounded noise
+and it is supra-Gaussian for q > 1. The noise is generated  via a stochastic
+differential equation using the Heun method (a second order Runge-Kutta type
+integration scheme) and it is implemented as a stand-alone library in c++. It
+Useful as input for numerical simulations, as a source of noise for controlling
+experiments using synthetic noise via micro-controllers and for a wide variety
+of applications.
+
+Requirements
+It is a stand-alone library with no dependencies other than the standard
+libraries. Due to it's use of some functions from the <random> library the
+library currently works on c++11 or higher only. This should be OK for most Macs
+and new Linux systems. In some older systems it is possible that you need to add
+`-std=gnu++11` to your compilation flags.
+
+Licence
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef QNOISEMULTI_H
+#define QNOISEMULTI_H
+
+#include <algorithm>
+#include <vector>
+#include "qNoise.h"
+
+/*
+ * qNoiseMulti advances many independent qNoise paths in lockstep.
+ * The state of the paths is kept as a structure of arrays and on each step the
+ * Gaussian draws of every path are filled in one block, by default by the
+ * Ziggurat backend (see setGaussBackend) straight into that array. The
+ * sampler itself is scalar (a table lookup and a rare rejection per variate),
+ * so the draws are not vectorized and with many paths they take most of the
+ * time of a step. The step of all the paths (Heun, or the exact
+ * update for q=1) is a branch-free loop that the compiler vectorizes; on
+ * x86-64 with GCC it is compiled for AVX-512, AVX2 and a generic target and
+ * the best one is chosen at run time. The rejection-free step for q<1
+ * (BOUNDED_IMPLICIT) is vectorized too when built with -fno-math-errno (as
+ * the makefile does), which lets the square root of its start be a vector
+ * instruction. The paths that fall out of bounds (only possible for q<1 with the
+ * retry scheme) are collected and retried one by one with the same scheme as
+ * qNoiseGen::qNoise, so a single path out of bounds does not stall the rest.
+ * Each path follows the same statistics as a series generated with qNoise.
+ * The lanes and the scalar steps of qNoise.cpp are both compiled without
+ * contraction into FMA (with GCC and Clang), so they round the same way: a
+ * single path is bit for bit the series of qNoise with the same seed and
+ * backend, also with -march=native.
+ *
+ * The paths can also be the channels of a multichannel noise: with
+ * setCorrelation the Gaussian draws of each step are mixed by the Cholesky
+ * factor of a correlation matrix before the step, so the forcing of the
+ * channels has that correlation (and for q=1 the channels themselves).
+ * The mixing is a lower triangular mat-vec done column by column, a
+ * vectorized axpy per column. A path retried out of bounds takes an
+ * independent draw for that step.
+ */
+// Layout of the output of qNoiseMulti::qNoise
+enum qNoiseLayout {
+    LAYOUT_INTERLEAVED,  // out[s * paths + i], path i at step s
+    LAYOUT_PLANAR        // out[i * steps + s]
+};
+
+class qNoiseMulti {
+    qNoiseGen gen;
+    qNoiseParams p;
+    std::vector<double> eta, next, noise, draws;
+    std::vector<double> mixing;  // Cholesky factor, column major, or empty
+    std::vector<size_t> outOfBounds;
+
+public:
+    qNoiseMulti(size_t paths, double tau, double q, double H);
+    qNoiseMulti(size_t paths, const qNoiseParams &p);
+
+    void seedManual(unsigned UserSeed) { gen.seedManual(UserSeed); }
+    void seedTimer() { gen.seedTimer(); }
+    // Source of the Gaussian draws, GAUSS_ZIGGURAT unless set otherwise
+    void setGaussBackend(qNoiseGen::gaussBackend backend) {
+        gen.setGaussBackend(backend);
+    }
+    // With BOUNDED_IMPLICIT and q<1 every path takes the rejection-free step,
+    // see qNoiseGenT::setBoundedScheme. No path is ever retried.
+    void setBoundedScheme(qNoiseGen::boundedScheme scheme) {
+        gen.setBoundedScheme(scheme);
+    }
+    qNoiseStats getStats() const { return gen.getStats(); }
+    void resetStats() { gen.resetStats(); }
+    size_t paths() const { return eta.size(); }
+    // Current value of every path, zero at construction. It can be written.
+    double *state() { return eta.data(); }
+    // Draw the value of every path from the stationary PDF (see
+    // qNoiseGen::qNoiseStart for q>=3)
+    void stationaryState() {
+        for (size_t i = 0; i < eta.size(); i++)
+            eta[i] = gen.qNoiseStart(p);
+    }
+    // Correlation matrix of the Gaussian forcing of the paths, paths x paths
+    // and row major (only its lower triangle is read). Returns false, making
+    // the paths independent (whatever correlation they had before), if it is
+    // not positive definite or not paths x paths. An empty matrix makes them
+    // independent again.
+    bool setCorrelation(const std::vector<double> &correlation);
+    // Advance every path one time step and return the new state.
+    const double *step();
+    // Advance `steps` time steps writing the state after each one to out.
+    void qNoise(double *out, size_t steps,
+                qNoiseLayout layout = LAYOUT_INTERLEAVED);
+};
+
+#endif  // QNOISEMULTI_H
@@ -0,0 +1,314 @@
+/*
+qNoise: A generator of non-Gaussian colored noise
+Copyright © 2021, Juan Ignacio Deza
+email: ignacio.deza@uwe.ac.uk
+
+Description
+qNoise is a non-gaussian colored random noise generator. It is a handy source of
+self-correlated noise for a great variety of applications. It depends on two
+parameters only: tau for controlling the autocorrelation, and q for controlling
+the statistics. This noise tends smoothly  for q = 1 to an  Ornstein-Uhlenbeck
+(colored gaussian) noise with autocorrelation tau. for q < 1 it is bounded noise
+and it is supra-Gaussian for q > 1. The noise is generated  via a stochastic
+differential equation using the Heun method (a second order Runge-Kutta type
+integration scheme) and it is implemented as a stand-alone library in c++. It
+Useful as input for numerical simulations, as a source of noise for controlling
+experiments using synthetic noise via micro-controllers and for a wide variety
+of applications.
+
+Requirements
+It is a stand-alone library with no dependencies other than the standard
+libraries. Due to it's use of some functions from the <random> library the
+library currently works on c++11 or higher only. This should be OK for most Macs
+and new Linux systems. In some older systems it is possible that you need to add
+`-std=gnu++11` to your compilation flags.
+
+Licence
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef QNOISEONLINE_H
+#define QNOISEONLINE_H
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+/*
+ * Online statistics of a series, updated while it is generated in O(1)
+ * memory (independent of the length of the series) and mergeable, so that
+ * each thread can keep its own and combine them at the end. They are small
+ * and used in the inner loops, so they are defined inline here, as the
+ * generators of qNoiseGauss.h.
+ */
+
+/*
+ * Mean, variance and kurtosis (central moments up to the fourth, Pebay's
+ * update). add(x, n) takes a whole chunk with two passes over it, which is
+ * faster and more accurate than adding the points one by one.
+ */
+class qNoiseMoments {
+    double n, m1, m2, m3, m4;  // count, mean and sums of powers of x - mean
+
+public:
+    qNoiseMoments() : n(0), m1(0), m2(0), m3(0), m4(0) {}
+
+    void add(double x) {
+        double n1 = n;
+        n += 1;
+        double delta = x - m1, deltaN = delta / n, deltaN2 = deltaN * deltaN;
+        double term = delta * deltaN * n1;
+        m1 += deltaN;
+        m4 += term * deltaN2 * (n * n - 3 * n + 3) + 6 * deltaN2 * m2 -
+              4 * deltaN * m3;
+        m3 += term * deltaN * (n - 2) - 3 * deltaN * m2;
+        m2 += term;
+    }
+
+    void add(const double *x, size_t size) {
+        if (size == 0)
+            return;
+        qNoiseMoments chunk;
+        chunk.n = size;
+        double sum = 0;
+        for (size_t i = 0; i < size; i++)
+            sum += x[i];
+        chunk.m1 = sum / size;
+        for (size_t i = 0; i < size; i++) {
+            double d = x[i] - chunk.m1, d2 = d * d;
+            chunk.m2 += d2;
+            chunk.m3 += d2 * d;
+            chunk.m4 += d2 * d2;
+        }
+        merge(chunk);
+    }
+
+    void merge(const qNoiseMoments &o) {
+        if (o.n == 0)
+            return;
+        if (n == 0) {
+            *this = o;
+            return;
+        }
+        double na = n, nb = o.n, nt = na + nb;
+        double delta = o.m1 - m1, d2 = delta * delta;
+        double M2 = m2 + o.m2 + d2 * na * nb / nt;
+        double M3 = m3 + o.m3 + d2 * delta * na * nb * (na - nb) / (nt * nt) +
+                    3 * delta * (na * o.m2 - nb * m2) / nt;
+        double M4 = m4 + o.m4 +
+                    d2 * d2 * na * nb * (na * na - na * nb + nb * nb) /
+                        (nt * nt * nt) +
+                    6 * d2 * (na * na * o.m2 + nb * nb * m2) / (nt * nt) +
+                    4 * delta * (na * o.m3 - nb * m3) / nt;
+        m1 += delta * nb / nt;
+        m2 = M2;
+        m3 = M3;
+        m4 = M4;
+        n = nt;
+    }
+
+    double count() const { return n; }
+    double mean() const { return m1; }
+    double variance() const { return m2 / n; }
+    double skewness() const { return sqrt(n) * m3 / pow(m2, 1.5); }
+    // Not the excess: 3 for a Gaussian.
+    double kurtosis() const { return n * m4 / (m2 * m2); }
+};
+
+/*
+ * Histogram with a fixed number of bins.
+ * Fixed range, qNoiseHistogram(lower, upper, bins): the points outside are
+ * counted apart.
+ * Adaptive range, qNoiseHistogram(bins), with the bins rounded up to a
+ * multiple of 4: the range is [-2^e, 2^e), with e taken from the first
+ * point and increased, merging pairs of bins, whenever a point falls
+ * outside. Two adaptive histograms can then always be merged after growing
+ * the narrower one.
+ */
+class qNoiseHistogram {
+    std::vector<double> counts;
+    double lo, hi, width;
+    double below, above, total;
+    bool adaptive;
+    int e;  // adaptive range [-2^e, 2^e)
+
+    void setRange() {
+        hi = ldexp(1.0, e);
+        lo = -hi;
+        width = 2 * hi / counts.size();
+    }
+    // Double the adaptive range: the old one is its middle half
+    void grow() {
+        size_t bins = counts.size();
+        std::vector<double> merged(bins, 0.0);
+        for (size_t i = 0; i < bins; i++)
+            merged[(bins / 2 + i) / 2] += counts[i];
+        counts.swap(merged);
+        e++;
+        setRange();
+    }
+    void start(double x) {
+        e = x == 0 ? -30 : std::ilogb(x) + 1;
+        setRange();
+    }
+
+public:
+    qNoiseHistogram(double lower, double upper, int bins)
+        : counts(bins, 0.0), lo(lower), hi(upper),
+          width((upper - lower) / bins), below(0), above(0), total(0),
+          adaptive(false), e(0) {}
+    explicit qNoiseHistogram(int bins = 64)
+        : counts((bins + 3) / 4 * 4, 0.0), lo(0), hi(0), width(0), below(0),
+          above(0), total(0), adaptive(true), e(0) {}
+
+    void add(double x) {
+        if (adaptive && std::isfinite(x)) {
+            if (total == below + above)
+                start(x);
+            while (x < lo || x >= hi)
+                grow();
+        }
+        double b = floor((x - lo) / width);
+        if (b >= 0 && b < counts.size())
+            counts[size_t(b)]++;
+        else if (b < 0)
+            below++;
+        else
+            above++;  // also NaN
+        total++;
+    }
+    void add(const double *x, size_t size) {
+        for (size_t i = 0; i < size; i++)
+            add(x[i]);
+    }
+
+    // Histograms of different ranges can only be merged when both are
+    // adaptive, with the same number of bins.
+    bool merge(const qNoiseHistogram &o) {
+        if (o.total == 0)
+            return true;
+        if (o.counts.size() != counts.size() || o.adaptive != adaptive)
+            return false;
+        if (total == 0) {
+            *this = o;
+            return true;
+        }
+        if (adaptive) {
+            qNoiseHistogram other = o;
+            while (e < other.e)
+                grow();
+            while (other.e < e)
+                other.grow();
+            for (size_t i = 0; i < counts.size(); i++)
+                counts[i] += other.counts[i];
+        } else {
+            if (o.lo != lo || o.hi != hi)
+                return false;
+            for (size_t i = 0; i < counts.size(); i++)
+                counts[i] += o.counts[i];
+        }
+        below += o.below;
+        above += o.above;
+        total += o.total;
+        return true;
+    }
+
+    size_t bins() const { return counts.size(); }
+    double lower() const { return lo; }
+    double upper() const { return hi; }
+    double binWidth() const { return width; }
+    double center(size_t i) const { return lo + (i + 0.5) * width; }
+    double count(size_t i) const { return counts[i]; }
+    // Estimate of the PDF at the bin i
+    double density(size_t i) const { return counts[i] / (total * width); }
+    double underflow() const { return below; }
+    double overflow() const { return above; }
+    double count() const { return total; }
+};
+
+/*
+ * Autocorrelation of the series at the lags stride, 2 stride, ... up to
+ * maxLag, from the last maxLag points kept in a ring. For an
+ * Ornstein-Uhlenbeck noise it is exp(-lag H / tau), so tau(H) gives the
+ * effective correlation time. merge() pools the statistics of independent
+ * series (e.g. one per thread) with the same lags.
+ */
+class qNoiseAutocorr {
+    std::vector<double> ring, cross, pairs;
+    size_t stride, pos;
+    double n, sum, sum2;
+
+public:
+    explicit qNoiseAutocorr(size_t maxLag, size_t stride = 1)
+        : ring(maxLag, 0.0), cross(maxLag / stride, 0.0),
+          pairs(maxLag / stride, 0.0), stride(stride), pos(0), n(0), sum(0),
+          sum2(0) {}
+
+    void add(double x) {
+        size_t size = ring.size();
+        for (size_t j = 0; j < cross.size(); j++) {
+            size_t lag = (j + 1) * stride;
+            if (lag > n)
+                break;
+            cross[j] += x * ring[pos >= lag ? pos - lag : pos + size - lag];
+            pairs[j]++;
+        }
+        ring[pos] = x;
+        if (++pos == size)
+            pos = 0;
+        n++;
+        sum += x;
+        sum2 += x * x;
+    }
+    void add(const double *x, size_t size) {
+        for (size_t i = 0; i < size; i++)
+            add(x[i]);
+    }
+
+    void merge(const qNoiseAutocorr &o) {
+        for (size_t j = 0; j < cross.size() && j < o.cross.size(); j++) {
+            cross[j] += o.cross[j];
+            pairs[j] += o.pairs[j];
+        }
+        n += o.n;
+        sum += o.sum;
+        sum2 += o.sum2;
+    }
+
+    size_t lags() const { return cross.size(); }
+    size_t lag(size_t j) const { return (j + 1) * stride; }
+    // Autocorrelation at lag(j)
+    double rho(size_t j) const {
+        double mean = sum / n, var = sum2 / n - mean * mean;
+        return (cross[j] / pairs[j] - mean * mean) / var;
+    }
+    // Correlation time for a time step H: least squares fit of
+    // log(rho) = -lag H / tau over the lags where rho is positive.
+    double tau(double H) const {
+        double sxy = 0, sxx = 0;
+        for (size_t j = 0; j < cross.size(); j++) {
+            if (pairs[j] == 0)
+                continue;
+            double r = rho(j);
+            if (!(r > 0))
+                continue;
+            double t = lag(j) * H;
+            sxy += t * log(r);
+            sxx += t * t;
+        }
+        return -sxx / sxy;
+    }
+};
+
+#endif  // QNOISEONLINE_H
@@ -0,0 +1,94 @@
+/*
+qNoise: A generator of non-Gaussian colored noise
+Copyright © 2021, Juan Ignacio Deza
+email: ignacio.deza@uwe.ac.uk
+
+Description
+qNoise is a non-gaussian colored random noise generator. It is a handy source of
+self-correlated noise for a great variety of applications. It depends on two
+parameters only: tau for controlling the autocorrelation, and q for controlling
+the statistics. This noise tends smoothly  for q = 1 to an  Ornstein-Uhlenbeck
+(colored gaussian) noise with autocorrelation tau. for q < 1 it is bounded noise
+and it is supra-Gaussian for q > 1. The noise is generated  via a stochastic
+differential equation using the Heun method (a second order Runge-Kutta type
+integration scheme) and it is implemented as a stand-alone library in c++. It
+Useful as input for numerical simulations, as a source of noise for controlling
+experiments using synthetic noise via micro-controllers and for a wide variety
+of applications.
+
+Requirements
+It is a stand-alone library with no dependencies other than the standard
+libraries. Due to it's use of some functions from the <random> library the
+library currently works on c++11 or higher only. This should be OK for most Macs
+and new Linux systems. In some older systems it is possible that you need to add
+`-std=gnu++11` to your compilation flags.
+
+Licence
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <atomic>
+#include "qNoisePool.h"
+
+qNoisePool::qNoisePool(unsigned masterSeed, unsigned threads)
+    : masterSeed(masterSeed), gens(threads > 0 ? threads : 1) {
+  xoshiro256pp engine(masterSeed);
+  for (size_t w = 0; w < gens.size(); w++) {
+    engine.longJump();
+    gens[w].setGaussBackend(qNoiseGen::GAUSS_ZIGGURAT);
+    gens[w].seedEngine(masterSeed, engine);
+  }
+}
+
+void qNoisePool::parallel_generate(double *out, size_t paths, size_t n,
+                                   const qNoiseParams &p, double eta0) {
+  generate(out, paths, n, p, eta0, false);
+}
+
+void qNoisePool::parallel_generate_stationary(double *out, size_t paths,
+                                              size_t n,
+                                              const qNoiseParams &p) {
+  generate(out, paths, n, p, 0, true);
+}
+
+void qNoisePool::generate(double *out, size_t paths, size_t n,
+                          const qNoiseParams &p, double eta0,
+                          bool stationary) {
+  // The starting state of every path, one jump apart.
+  std::vector<xoshiro256pp> streams(paths);
+  xoshiro256pp engine(masterSeed);
+  for (size_t j = 0; j < paths; j++) {
+    streams[j] = engine;
+    engine.jump();
+  }
+
+  // Each worker takes the next path to generate until there are none left.
+  std::atomic<size_t> nextPath(0);
+  std::vector<std::thread> workers;
+  for (size_t w = 0; w < gens.size(); w++) {
+    workers.push_back(std::thread([&, w]() {
+      qNoiseGen &gen = gens[w];
+      xoshiro256pp own = gen.fastGenerator;
+      for (size_t j = nextPath++; j < paths; j = nextPath++) {
+        gen.seedEngine(masterSeed, streams[j]);
+        double start = stationary ? gen.qNoiseStart(p) : eta0;
+        gen.qNoise(out + j * n, n, start, p);
+      }
+      // Give the worker its own stream back
+      gen.seedEngine(masterSeed, own);
+    }));
+  }
+  for (size_t w = 0; w < workers.size(); w++)
+    workers[w].join();
+}
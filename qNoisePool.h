@@ -0,0 +1,90 @@
+/*
+qNoise: A generator of non-Gaussian colored noise
+Copyright © 2021, Juan Ignacio Deza
+email: ignacio.deza@uwe.ac.uk
+
+Description
+qNoise is a non-gaussian colored random noise generator. It is a handy source of
+self-correlated noise for a great variety of applications. It depends on two
+parameters only: tau for controlling the autocorrelation, and q for controlling
+the statistics. This noise tends smoothly  for q = 1 to an  Ornstein-Uhlenbeck
+(colored gaussian) noise with autocorrelation tau. for q < 1 it is bounded noise
+and it is supra-Gaussian for q > 1. The noise is generated  via a stochastic
+differential equation using the Heun method (a second order Runge-Kutta type
+integration scheme) and it is implemented as a stand-alone library in c++. It
+Useful as input for numerical simulations, as a source of noise for controlling
+experiments using synthetic noise via micro-controllers and for a wide variety
+of applications.
+
+Requirements
+It is a stand-alone library with no dependencies other than the standard
+libraries. Due to it's use of some functions from the <random> library the
+library currently works on c++11 or higher only. This should be OK for most Macs
+and new Linux systems. In some older systems it is possible that you need to add
+`-std=gnu++11` to your compilation flags.
+
+Licence
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef QNOISEPOOL_H
+#define QNOISEPOOL_H
+
+#include <thread>
+#include <vector>
+#include "qNoise.h"
+
+/*
+ * qNoisePool hands one generator to each worker thread from a single master
+ * seed. The generators use the Ziggurat backend and their xoshiro256++
+ * sequences are split with jump-ahead, so the streams are guaranteed not to
+ * overlap (each one has 2^128 draws).
+ *
+ * Worker w gets the stream after w+1 long jumps (2^192 draws). The paths of
+ * parallel_generate use the streams of plain jumps (2^128 draws) from the
+ * master seed, path j the j-th one, so they do not overlap with the workers
+ * and the result does not depend on the number of threads.
+ *
+ * The work is split by paths only: a path is generated by a single worker, so
+ * parallel_generate of fewer paths than workers leaves some of them idle, and
+ * one path runs on one core. A long series can be split into paths started
+ * from the stationary PDF, which are independent segments of it.
+ */
+class qNoisePool {
+    unsigned masterSeed;
+    std::vector<qNoiseGen> gens;
+    void generate(double *out, size_t paths, size_t n, const qNoiseParams &p,
+                  double eta0, bool stationary);
+
+public:
+    explicit qNoisePool(unsigned masterSeed,
+                        unsigned threads = std::thread::hardware_concurrency());
+
+    size_t size() const { return gens.size(); }
+    // Generator of the worker thread w, only to be used from that thread.
+    qNoiseGen &operator[](size_t w) { return gens[w]; }
+
+    // Generate `paths` independent series of n points of qNoise, using every
+    // worker. out[j * n + i] is the point i of the path j, which starts from
+    // eta0. The same master seed always gives the same output.
+    void parallel_generate(double *out, size_t paths, size_t n,
+                           const qNoiseParams &p, double eta0 = 0);
+    // The same, but every path starts from a value of the stationary PDF
+    // drawn from its own stream (qNoiseGen::qNoiseStart), so the paths are in
+    // equilibrium from the first point.
+    void parallel_generate_stationary(double *out, size_t paths, size_t n,
+                                      const qNoiseParams &p);
+};
+
+#endif  // QNOISEPOOL_H
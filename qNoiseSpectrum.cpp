@@ -0,0 +1,169 @@
+/*
+qNoise: A generator of non-Gaussian colored noise
+Copyright © 2021, Juan Ignacio Deza
+email: ignacio.deza@uwe.ac.uk
+
+Description
+qNoise is a non-gaussian colored random noise generator. It is a handy source of
+self-correlated noise for a great variety of applications. It depends on two
+parameters only: tau for controlling the autocorrelation, and q for controlling
+the statistics. This noise tends smoothly  for q = 1 to an  Ornstein-Uhlenbeck
+(colored gaussian) noise with autocorrelation tau. for q < 1 it is bounded noise
+and it is supra-Gaussian for q > 1. The noise is generated  via a stochastic
+differential equation using the Heun method (a second order Runge-Kutta type
+integration scheme) and it is implemented as a stand-alone library in c++. It
+Useful as input for numerical simulations, as a source of noise for controlling
+experiments using synthetic noise via micro-controllers and for a wide variety
+of applications.
+
+Requirements
+It is a stand-alone library with no dependencies other than the standard
+libraries. Due to it's use of some functions from the <random> library the
+library currently works on c++11 or higher only. This should be OK for most Macs
+and new Linux systems. In some older systems it is possible that you need to add
+`-std=gnu++11` to your compilation flags.
+
+Licence
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include "qNoiseSpectrum.h"
+
+void qNoiseFFT(std::complex<double> *x, size_t n, bool inverse) {
+  // Other sizes would give a wrong transform without any error
+  assert((n & (n - 1)) == 0);
+  // Bit reversal permutation
+  for (size_t i = 1, j = 0; i < n; i++) {
+    size_t bit = n >> 1;
+    for (; j & bit; bit >>= 1)
+      j ^= bit;
+    j ^= bit;
+    if (i < j)
+      std::swap(x[i], x[j]);
+  }
+  // Butterflies, the twiddle factors of each stage by recurrence
+  for (size_t len = 2; len <= n; len <<= 1) {
+    double angle = (inverse ? 2 : -2) * M_PI / len;
+    std::complex<double> wLen(cos(angle), sin(angle));
+    for (size_t i = 0; i < n; i += len) {
+      std::complex<double> w(1, 0);
+      for (size_t k = 0; k < len / 2; k++) {
+        std::complex<double> u = x[i + k], v = x[i + k + len / 2] * w;
+        x[i + k] = u + v;
+        x[i + k + len / 2] = u - v;
+        w *= wLen;
+      }
+    }
+  }
+}
+
+qNoiseSpectrum::qNoiseSpectrum(double H, size_t segment, size_t decimation)
+    : segment(segment), decimation(decimation > 0 ? decimation : 1),
+      buffer(segment), window(segment), work(2 * segment),
+      power(segment / 2 + 1, 0.0), corr(segment, 0.0), fill(0), segments(0),
+      corrSegments(0), blockSum(0), blockCount(0) {
+  assert(segment >= 2 && (segment & (segment - 1)) == 0);
+  dt = H * this->decimation;
+  for (size_t i = 0; i < segment; i++)
+    window[i] = 0.5 - 0.5 * cos(2 * M_PI * i / segment);
+}
+
+void qNoiseSpectrum::addPoint(double x) {
+  buffer[fill++] = x;
+  if (fill == segment)
+    segmentDone();
+}
+
+/*
+ * A full segment: its periodogram always, and its autocorrelation one time
+ * out of two, when it does not overlap the previous one. The second half is
+ * kept as the first half of the next segment.
+ */
+void qNoiseSpectrum::segmentDone() {
+  double mean = 0;
+  for (size_t i = 0; i < segment; i++)
+    mean += buffer[i];
+  mean /= segment;
+
+  double norm = 0;
+  for (size_t i = 0; i < segment; i++) {
+    work[i] = (buffer[i] - mean) * window[i];
+    norm += window[i] * window[i];
+  }
+  qNoiseFFT(work.data(), segment);
+  for (size_t k = 0; k < power.size(); k++) {
+    double p = std::norm(work[k]) * dt / norm;
+    // One-sided: the negative frequencies are added, except for 0 and Nyquist
+    power[k] += (k == 0 || k == segment / 2) ? p : 2 * p;
+  }
+
+  if (segments % 2 == 0) {
+    for (size_t i = 0; i < segment; i++)
+      work[i] = buffer[i] - mean;
+    for (size_t i = segment; i < 2 * segment; i++)
+      work[i] = 0;
+    qNoiseFFT(work.data(), 2 * segment);
+    for (size_t i = 0; i < 2 * segment; i++)
+      work[i] = std::norm(work[i]);
+    qNoiseFFT(work.data(), 2 * segment, true);
+    // Average of the products at each lag
+    for (size_t j = 0; j < segment; j++)
+      corr[j] += work[j].real() / (2 * segment) / (segment - j);
+    corrSegments++;
+  }
+  segments++;
+
+  std::copy(buffer.begin() + segment / 2, buffer.end(), buffer.begin());
+  fill = segment / 2;
+}
+
+double qNoiseSpectrum::psd(size_t k) const {
+  return segments > 0 ? power[k] / segments : 0;
+}
+
+double qNoiseSpectrum::tauACF() const {
+  double stt = 0, stl = 0;
+  for (size_t j = 1; j < corr.size(); j++) {
+    double rho = acf(j);
+    if (!(rho > 0.1))
+      break;
+    double t = lagTime(j);
+    stt += t * t;
+    stl += t * log(rho);
+  }
+  return -stt / stl;
+}
+
+double qNoiseSpectrum::tauPSD() const {
+  // Least squares of S (a + b f^2) = 1, i.e. of the relative error of the
+  // Lorentzian 1 / (a + b f^2), then tau = sqrt(b / a) / (2 pi)
+  double s11 = 0, s12 = 0, s22 = 0, r1 = 0, r2 = 0;
+  // From k = 2, as k = 0 and 1 are affected by the removal of the mean
+  for (size_t k = 2; k < power.size(); k++) {
+    double S = psd(k), Sf2 = S * frequency(k) * frequency(k);
+    if (S < psd(2) / 10)
+      break;
+    s11 += S * S;
+    s12 += S * Sf2;
+    s22 += Sf2 * Sf2;
+    r1 += S;
+    r2 += Sf2;
+  }
+  double det = s11 * s22 - s12 * s12;
+  double a = (r1 * s22 - r2 * s12) / det, b = (s11 * r2 - s12 * r1) / det;
+  return sqrt(b / a) / (2 * M_PI);
+}
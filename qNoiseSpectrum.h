@@ -0,0 +1,115 @@
+/*
+qNoise: A generator of non-Gaussian colored noise
+Copyright © 2021, Juan Ignacio Deza
+email: ignacio.deza@uwe.ac.uk
+
+Description
+qNoise is a non-gaussian colored random noise generator. It is a handy source of
+self-correlated noise for a great variety of applications. It depends on two
+parameters only: tau for controlling the autocorrelation, and q for controlling
+the statistics. This noise tends smoothly  for q = 1 to an  Ornstein-Uhlenbeck
+(colored gaussian) noise with autocorrelation tau. for q < 1 it is bounded noise
+and it is supra-Gaussian for q > 1. The noise is generated  via a stochastic
+differential equation using the Heun method (a second order Runge-Kutta type
+integration scheme) and it is implemented as a stand-alone library in c++. It
+Useful as input for numerical simulations, as a source of noise for controlling
+experiments using synthetic noise via micro-controllers and for a wide variety
+of applications.
+
+Requirements
+It is a stand-alone library with no dependencies other than the standard
+libraries. Due to it's use of some functions from the <random> library the
+library currently works on c++11 or higher only. This should be OK for most Macs
+and new Linux systems. In some older systems it is possible that you need to add
+`-std=gnu++11` to your compilation flags.
+
+Licence
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef QNOISESPECTRUM_H
+#define QNOISESPECTRUM_H
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+// In-place radix-2 FFT of n complex values, n a power of 2 (asserted). The
+// inverse is not normalized (it returns n times the original values).
+void qNoiseFFT(std::complex<double> *x, size_t n, bool inverse = false);
+
+/*
+ * qNoiseSpectrum estimates the autocorrelation function and the power
+ * spectral density of a long series in O(N log segment) time and O(segment)
+ * memory, so that series of 1e8 points or more can be validated while they
+ * are generated. The series is cut in segments of `segment` points (a power
+ * of 2, at least 2, which the constructor asserts):
+ * - the PSD is the Welch average of the periodograms of segments with a Hann
+ *   window and 50% overlap;
+ * - the autocorrelation is the average over disjoint segments of their
+ *   autocorrelation up to segment - 1 lags, computed with the FFT of the
+ *   segment padded with zeros.
+ * The mean of each segment is removed. When the correlation time is many
+ * steps, blocks of `decimation` consecutive points can be averaged into one
+ * so that a segment covers many correlation times; the PSD is then only
+ * meaningful well below the new Nyquist frequency.
+ */
+class qNoiseSpectrum {
+    size_t segment, decimation;
+    double dt;  // time between the points of a segment
+    std::vector<double> buffer, window;
+    std::vector<std::complex<double> > work;
+    std::vector<double> power, corr;
+    size_t fill, segments, corrSegments;
+    double blockSum;
+    size_t blockCount;
+    void addPoint(double x);
+    void segmentDone();
+
+public:
+    qNoiseSpectrum(double H, size_t segment = 1 << 14, size_t decimation = 1);
+
+    void add(double x) {
+        blockSum += x;
+        if (++blockCount == decimation) {
+            addPoint(blockSum / decimation);
+            blockSum = 0;
+            blockCount = 0;
+        }
+    }
+    void add(const double *x, size_t n) {
+        for (size_t i = 0; i < n; i++)
+            add(x[i]);
+    }
+
+    // One-sided PSD at the frequency k / (segment dt), k up to segment / 2.
+    // Its integral over the frequency is the variance of the series.
+    size_t frequencies() const { return power.size(); }
+    double frequency(size_t k) const { return k / (segment * dt); }
+    double psd(size_t k) const;
+    // Normalized autocorrelation at the time lag j dt, j below segment.
+    size_t lags() const { return corr.size(); }
+    double lagTime(size_t j) const { return j * dt; }
+    double acf(size_t j) const { return corr[j] / corr[0]; }
+
+    // Correlation time fitted to exp(-t / tau) over the lags where the
+    // autocorrelation is above 0.1.
+    double tauACF() const;
+    // Correlation time fitted to the Lorentzian S0 / (1 + (2 pi f tau)^2)
+    // up to the frequency where the PSD falls to a tenth of its low frequency
+    // value.
+    double tauPSD() const;
+};
+
+#endif  // QNOISESPECTRUM_H
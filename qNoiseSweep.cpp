@@ -0,0 +1,195 @@
+/*
+qNoise: A generator of non-Gaussian colored noise
+Copyright © 2021, Juan Ignacio Deza
+email: ignacio.deza@uwe.ac.uk
+
+Description
+qNoise is a non-gaussian colored random noise generator. It is a handy source of
+self-correlated noise for a great variety of applications. It depends on two
+parameters only: tau for controlling the autocorrelation, and q for controlling
+the statistics. This noise tends smoothly  for q = 1 to an  Ornstein-Uhlenbeck
+(colored gaussian) noise with autocorrelation tau. for q < 1 it is bounded noise
+and it is supra-Gaussian for q > 1. The noise is generated  via a stochastic
+differential equation using the Heun method (a second order Runge-Kutta type
+integration scheme) and it is implemented as a stand-alone library in c++. It
+Useful as input for numerical simulations, as a source of noise for controlling
+experiments using synthetic noise via micro-controllers and for a wide variety
+of applications.
+
+Requirements
+It is a stand-alone library with no dependencies other than the standard
+libraries. Due to it's use of some functions from the <random> library the
+library currently works on c++11 or higher only. This should be OK for most Macs
+and new Linux systems. In some older systems it is possible that you need to add
+`-std=gnu++11` to your compilation flags.
+
+Licence
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include "qNoiseSweep.h"
+
+qNoiseSweepSpec::qNoiseSweepSpec()
+    : tau({0.1, 1., 10., 100.}),
+      q({0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 1., 1.1, 1.2, 1.3}),
+      N({long(1e4), long(1e5), long(1e6), long(1e7)}), H(0.001),
+      seed(1234567), norm(false), bins(50) {}
+
+double qNoisePDF(double x, double tau, double q) {
+  if (q == 1)
+    return exp(-tau * x * x);
+  double base = 1 - tau * (1 - q) * x * x;
+  // Outside the support for q<1
+  if (base <= 0)
+    return 0;
+  return pow(base, 1 / (1 - q));
+}
+
+/*
+ * Half width of the histogram: the bound of the support for q<1, otherwise
+ * the point where the PDF falls to 1e-6 of its maximum.
+ */
+static double pdfRange(double tau, double q) {
+  if (q < 1)
+    return 1 / sqrt(tau * (1 - q));
+  if (q == 1)
+    return sqrt(log(1e6) / tau);
+  return sqrt((pow(1e-6, 1 - q) - 1) / (tau * (q - 1)));
+}
+
+qNoiseSweep::qNoiseSweep(const qNoiseSweepSpec &spec) : spec(spec) {
+  std::sort(this->spec.N.begin(), this->spec.N.end());
+}
+
+/*
+ * Generate the series of the configuration k up to the largest N and store
+ * the statistics of each of its prefixes.
+ */
+void qNoiseSweep::runConfig(size_t k) {
+  size_t nq = spec.q.size(), nN = spec.N.size();
+  double tau = spec.tau[k / nq], q = spec.q[k % nq];
+  qNoiseParams p = spec.norm ? qNoiseParams::norm(tau, q, spec.H)
+                             : qNoiseParams(tau, q, spec.H);
+  qNoiseGen gen;
+  gen.seedStream(spec.seed, k);
+
+  // Theoretical probability of each bin (Simpson's rule) and its total
+  int bins = spec.bins;
+  double L = pdfRange(p.tau, q), width = 2 * L / bins;
+  std::vector<double> theory(bins);
+  double total = 0;
+  for (int b = 0; b < bins; b++) {
+    double x0 = -L + b * width, sum = 0;
+    for (int s = 0; s <= 8; s++) {
+      double w = (s == 0 || s == 8) ? 1 : (s % 2 ? 4 : 2);
+      sum += w * qNoisePDF(x0 + s * width / 8, p.tau, q);
+    }
+    theory[b] = sum;
+    total += sum;
+  }
+
+  std::vector<double> chunk(1 << 16);
+  qNoiseMoments moments;
+  qNoiseHistogram hist(-L, L, bins);
+  // Lags up to twice the correlation time
+  size_t stride = std::max(1L, lround(p.tau / spec.H / 8));
+  qNoiseAutocorr autocorr(16 * stride, stride);
+  long int done = 0;
+  double eta = gen.qNoiseStart(p);
+  for (size_t n = 0; n < nN; n++) {
+    // Only the points after the previous N are generated
+    while (done < spec.N[n]) {
+      size_t size = std::min(long(chunk.size()), spec.N[n] - done);
+      eta = gen.qNoise(chunk.data(), size, eta, p);
+      moments.add(chunk.data(), size);
+      hist.add(chunk.data(), size);
+      autocorr.add(chunk.data(), size);
+      done += size;
+    }
+
+    qNoiseSweepResult &r = res[k * nN + n];
+    r.tau = tau;
+    r.q = q;
+    r.N = done;
+    r.mean = moments.mean();
+    r.variance = moments.variance();
+    r.kurtosis = moments.kurtosis();
+    r.tauEff = autocorr.tau(spec.H);
+    r.outside = (hist.underflow() + hist.overflow()) / done;
+    double distance = r.outside;
+    for (int b = 0; b < bins; b++)
+      distance += fabs(hist.count(b) / done - theory[b] / total);
+    r.distance = distance / 2 * 100;
+  }
+}
+
+void qNoiseSweep::run(unsigned threads) {
+  size_t configs = spec.tau.size() * spec.q.size();
+  res.assign(configs * spec.N.size(), qNoiseSweepResult());
+  if (threads == 0)
+    threads = 1;
+  if (threads > configs)
+    threads = configs;
+
+  // Deal the configurations to the workers
+  std::vector<std::deque<size_t> > queues(threads);
+  std::vector<std::mutex> locks(threads);
+  for (size_t k = 0; k < configs; k++)
+    queues[k % threads].push_back(k);
+
+  std::vector<std::thread> workers;
+  for (unsigned w = 0; w < threads; w++) {
+    workers.push_back(std::thread([&, w]() {
+      while (1) {
+        // Own work from the back, stolen work from the front
+        bool found = false;
+        size_t k = 0;
+        for (unsigned i = 0; i < threads && !found; i++) {
+          unsigned v = (w + i) % threads;
+          std::lock_guard<std::mutex> lock(locks[v]);
+          if (queues[v].empty())
+            continue;
+          if (v == w) {
+            k = queues[v].back();
+            queues[v].pop_back();
+          } else {
+            k = queues[v].front();
+            queues[v].pop_front();
+          }
+          found = true;
+        }
+        // No work is ever added, so there is nothing left anywhere
+        if (!found)
+          return;
+        runConfig(k);
+      }
+    }));
+  }
+  for (size_t w = 0; w < workers.size(); w++)
+    workers[w].join();
+}
+
+void qNoiseSweep::write(std::ostream &os) const {
+  os << "# tau\tq\tN\tmean\tvariance\tkurtosis\ttauEff\tdistance(%)"
+        "\toutside\n";
+  for (size_t i = 0; i < res.size(); i++) {
+    const qNoiseSweepResult &r = res[i];
+    os << r.tau << '\t' << r.q << '\t' << r.N << '\t' << r.mean << '\t'
+       << r.variance << '\t' << r.kurtosis << '\t' << r.tauEff << '\t'
+       << r.distance << '\t' << r.outside << '\n';
+  }
+}
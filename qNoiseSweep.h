@@ -0,0 +1,108 @@
+/*
+qNoise: A generator of non-Gaussian colored noise
+Copyright © 2021, Juan Ignacio Deza
+email: ignacio.deza@uwe.ac.uk
+
+Description
+qNoise is a non-gaussian colored random noise generator. It is a handy source of
+self-correlated noise for a great variety of applications. It depends on two
+parameters only: tau for controlling the autocorrelation, and q for controlling
+the statistics. This noise tends smoothly  for q = 1 to an  Ornstein-Uhlenbeck
+(colored gaussian) noise with autocorrelation tau. for q < 1 it is bounded noise
+and it is supra-Gaussian for q > 1. The noise is generated  via a stochastic
+differential equation using the Heun method (a second order Runge-Kutta type
+integration scheme) and it is implemented as a stand-alone library in c++. It
+Useful as input for numerical simulations, as a source of noise for controlling
+experiments using synthetic noise via micro-controllers and for a wide variety
+of applications.
+
+Requirements
+It is a stand-alone library with no dependencies other than the standard
+libraries. Due to it's use of some functions from the <random> library the
+library currently works on c++11 or higher only. This should be OK for most Macs
+and new Linux systems. In some older systems it is possible that you need to add
+`-std=gnu++11` to your compilation flags.
+
+Licence
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef QNOISESWEEP_H
+#define QNOISESWEEP_H
+
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "qNoise.h"
+#include "qNoiseOnline.h"
+
+/*
+ * Grid of a parameter sweep: every pair (tau, q) is generated once, with
+ * the largest N, and the statistics of every N are taken from the prefixes of
+ * that series. The default is the grid of unit_tests.cpp.
+ */
+struct qNoiseSweepSpec {
+    std::vector<double> tau, q;
+    std::vector<long int> N;
+    double H;
+    unsigned seed;
+    bool norm;  // qNoiseNorm instead of qNoise
+    int bins;   // bins of the histogram compared with the theoretical PDF
+
+    qNoiseSweepSpec();
+};
+
+// Statistics of the first N points of the series of (tau, q).
+struct qNoiseSweepResult {
+    double tau, q;
+    long int N;
+    double mean, variance, kurtosis;
+    // Correlation time fitted to the autocorrelation, see qNoiseAutocorr
+    double tauEff;
+    // Distance (total variation, in %) between the histogram and the
+    // stationary PDF, and the fraction of points outside its range.
+    double distance, outside;
+};
+
+/*
+ * qNoiseSweep runs a grid on a pool of threads with work stealing. Each
+ * worker has its own deque of configurations, takes the next one from its
+ * back and, when it is empty, steals from the front of the others. The series
+ * is generated in chunks and never stored: the moments, the histogram and
+ * the autocorrelation are accumulated as it goes (qNoiseOnline.h) and read
+ * at each N. The configuration k uses stream
+ * k of the seed (see qNoiseGenT::seedStream), so the results do not depend on
+ * the number of threads.
+ */
+class qNoiseSweep {
+    qNoiseSweepSpec spec;
+    std::vector<qNoiseSweepResult> res;
+
+    void runConfig(size_t k);
+
+public:
+    explicit qNoiseSweep(const qNoiseSweepSpec &spec);
+
+    void run(unsigned threads = std::thread::hardware_concurrency());
+    // Results ordered by tau and q as in the spec, and by increasing N.
+    const std::vector<qNoiseSweepResult> &results() const { return res; }
+    // All the results as a table with a header line.
+    void write(std::ostream &os) const;
+};
+
+// Stationary PDF of qNoise, not normalized. tau is the tau of qNoise (for
+// qNoiseNorm, tau * (5 - 3q) / 2).
+double qNoisePDF(double x, double tau, double q);
+
+#endif  // QNOISESWEEP_H
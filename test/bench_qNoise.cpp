@@ -0,0 +1,328 @@
+/*
+qNoise: A generator of non-Gaussian colored noise
+Copyright © 2021, Juan Ignacio Deza
+email: ignacio.deza@uwe.ac.uk
+
+Description
+qNoise is a non-gaussian colored random noise generator. It is a handy source of self-correlated noise for a great variety of applications. It depends on two parameters only: tau for controlling the autocorrelation, and q for controlling the statistics. This noise tends smoothly  for q = 1 to an  Ornstein-Uhlenbeck (colored gaussian) noise with autocorrelation tau. for q < 1 it is bounded noise and it is supra-Gaussian for q > 1.
+The noise is generated  via a stochastic differential equation using the Heun method (a second order Runge-Kutta type integration scheme) and it is implemented as a stand-alone library in c++.
+It Useful as input for numerical simulations, as a source of noise for controlling experiments using synthetic noise via micro-controllers and for a wide variety of applications.
+
+Requirements
+It is a stand-alone library with no dependencies other than the standard libraries.
+Due to it's use of some functions from the <random> library the library currently works on c++11 or higher only.
+This should be OK for most Macs and new Linux systems.
+In some older systems it is possible that you need to add `-std=gnu++11` to your compilation flags.
+
+Licence
+ This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../qNoise.h"
+#include "../qNoiseMulti.h"
+#include "../qNoisePool.h"
+#include "../qNoiseIO.h"
+#include "../qNoiseFeed.h"
+
+/*
+ * Benchmark suite of qNoise. It measures the time per sample of every
+ * generator (gaussWN, orsUhl, qNoise, qNoiseNorm) over the grid of q and tau
+ * of the unit tests, the single sample and batch versions, the sources of
+ * Gaussian variates, the multi-path engine, the generator pool with 1 to all
+ * the threads, the output formats and the real-time feed. When compiled with
+ * QNOISE_STATS (make bench DEFS=-DQNOISE_STATS) it also reports the cost of
+ * the boundary rejection loop of qNoise for q<1.
+ * Use: ./bench_qNoise [N] [--csv file] [--json file]
+ * The results are printed as a table and optionally saved as CSV or JSON to
+ * keep track of regressions.
+ */
+typedef std::chrono::steady_clock benchClock;
+
+struct benchResult {
+    std::string group, function, variant;
+    double tau, q;
+    unsigned threads;
+    long int samples;
+    double ns; //time per sample in nanoseconds
+};
+
+static std::vector<benchResult> results;
+
+static double nsPerSample(benchClock::time_point start, long int N) {
+    std::chrono::duration<double, std::nano> elapsed = benchClock::now() - start;
+    return elapsed.count() / N;
+}
+
+static void record(const std::string &group, const std::string &function,
+                   const std::string &variant, double tau, double q,
+                   unsigned threads, long int samples, double ns) {
+    benchResult r = {group, function, variant, tau, q, threads, samples, ns};
+    results.push_back(r);
+    std::cout << group << "\t" << function << "\t" << variant << "\t" << tau
+              << "\t" << q << "\t" << threads << "\t" << samples << "\t" << ns
+              << "\t" << 1e9 / ns << std::endl;
+}
+
+static void saveCSV(const char *fileName) {
+    std::ofstream file(fileName);
+    file << "group,function,variant,tau,q,threads,samples,ns_per_sample,samples_per_sec\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const benchResult &r = results[i];
+        file << r.group << "," << r.function << "," << r.variant << "," << r.tau
+             << "," << r.q << "," << r.threads << "," << r.samples << "," << r.ns
+             << "," << 1e9 / r.ns << "\n";
+    }
+}
+
+static void saveJSON(const char *fileName) {
+    std::ofstream file(fileName);
+    file << "[\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const benchResult &r = results[i];
+        file << "  {\"group\": \"" << r.group << "\", \"function\": \"" << r.function
+             << "\", \"variant\": \"" << r.variant << "\", \"tau\": " << r.tau
+             << ", \"q\": " << r.q << ", \"threads\": " << r.threads
+             << ", \"samples\": " << r.samples << ", \"ns_per_sample\": " << r.ns
+             << ", \"samples_per_sec\": " << 1e9 / r.ns << "}"
+             << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    file << "]\n";
+}
+
+int main(int argc, char** argv) {
+    long int N = 1000000;
+    // Paths of the multi-path and pool benchmarks, N must be at least that
+    const size_t paths = 1024;
+    const char *csvName = 0, *jsonName = 0;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--csv") && i + 1 < argc)
+            csvName = argv[++i];
+        else if (!strcmp(argv[i], "--json") && i + 1 < argc)
+            jsonName = argv[++i];
+        else if (atol(argv[i]) >= long(paths))
+            N = atol(argv[i]);
+        else {
+            std::cerr << "Use: " << argv[0] << " [N] [--csv file] [--json file]"
+                      << ", with N >= " << paths << std::endl;
+            return 1;
+        }
+    }
+    double H = 0.001, sqrt_H = sqrt(H);
+    double q[] = {0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 1., 1.1, 1.2, 1.3};
+    double tau[] = {0.1, 1., 10., 100.};
+    std::vector<double> data(N);
+    qNoiseGen gen;
+    gen.seedManual(12345678);
+    std::cout << "group\tfunction\tvariant\ttau\tq\tthreads\tsamples\tns/sample\tsamples/s" << std::endl;
+
+    // Gaussian white noise from every source
+    {
+        benchClock::time_point start = benchClock::now();
+        for (long int i = 0; i < N; i++)
+            data[i] = gen.gaussWN();
+        record("generator", "gaussWN", "loop-std", 0, 1, 1, N, nsPerSample(start, N));
+        start = benchClock::now();
+        gen.gaussWN(data.data(), N);
+        record("generator", "gaussWN", "batch-std", 0, 1, 1, N, nsPerSample(start, N));
+        gen.setGaussBackend(qNoiseGen::GAUSS_ZIGGURAT);
+        start = benchClock::now();
+        gen.gaussWN(data.data(), N);
+        record("generator", "gaussWN", "batch-ziggurat", 0, 1, 1, N, nsPerSample(start, N));
+        gen.setGaussBackend(qNoiseGen::GAUSS_STD);
+        qNoiseGenPhilox genPhilox;
+        start = benchClock::now();
+        genPhilox.gaussWN(data.data(), N);
+        record("generator", "gaussWN", "batch-philox", 0, 1, 1, N, nsPerSample(start, N));
+    }
+
+    // Ornstein-Uhlenbeck over the tau grid
+    for (double t : tau) {
+        double x = 0;
+        benchClock::time_point start = benchClock::now();
+        for (long int i = 0; i < N; i++) {
+            x = gen.orsUhl(x, t, H);
+            data[i] = x;
+        }
+        record("generator", "orsUhl", "loop", t, 1, 1, N, nsPerSample(start, N));
+        start = benchClock::now();
+        gen.orsUhl(data.data(), N, 0, qNoiseParams(t, 1, H));
+        record("generator", "orsUhl", "batch", t, 1, 1, N, nsPerSample(start, N));
+    }
+
+    // qNoise and qNoiseNorm over the grid of tau and q
+    for (double t : tau) {
+        for (double qi : q) {
+            double x = 0;
+            benchClock::time_point start = benchClock::now();
+            for (long int i = 0; i < N; i++) {
+                x = gen.qNoise(x, t, qi, H, sqrt_H);
+                data[i] = x;
+            }
+            record("generator", "qNoise", "loop", t, qi, 1, N, nsPerSample(start, N));
+            start = benchClock::now();
+            gen.qNoise(data.data(), N, 0, qNoiseParams(t, qi, H));
+            record("generator", "qNoise", "batch", t, qi, 1, N, nsPerSample(start, N));
+            gen.setGaussBackend(qNoiseGen::GAUSS_ZIGGURAT);
+            start = benchClock::now();
+            gen.qNoise(data.data(), N, 0, qNoiseParams(t, qi, H));
+            record("generator", "qNoise", "batch-ziggurat", t, qi, 1, N, nsPerSample(start, N));
+            gen.setGaussBackend(qNoiseGen::GAUSS_STD);
+            if (qi < 1) {
+                gen.setBoundedScheme(qNoiseGen::BOUNDED_IMPLICIT);
+                start = benchClock::now();
+                gen.qNoise(data.data(), N, 0, qNoiseParams(t, qi, H));
+                record("generator", "qNoise", "batch-implicit", t, qi, 1, N, nsPerSample(start, N));
+                gen.setBoundedScheme(qNoiseGen::BOUNDED_RETRY);
+            }
+
+            x = 0;
+            start = benchClock::now();
+            for (long int i = 0; i < N; i++) {
+                x = gen.qNoiseNorm(x, t, qi, H, sqrt_H);
+                data[i] = x;
+            }
+            record("generator", "qNoiseNorm", "loop", t, qi, 1, N, nsPerSample(start, N));
+            start = benchClock::now();
+            gen.qNoise(data.data(), N, 0, qNoiseParams::norm(t, qi, H));
+            record("generator", "qNoiseNorm", "batch", t, qi, 1, N, nsPerSample(start, N));
+        }
+    }
+
+#ifdef QNOISE_STATS
+    // Cost of the boundary rejection loop for q<1 (only with QNOISE_STATS)
+    std::cout << "retries\ttau\tq\tphase1\tphase2\tresets\twasted draws/sample\tmax rejected" << std::endl;
+    for (double t : tau) {
+        for (double qi : q) {
+            if (qi >= 1)
+                continue;
+            gen.resetStats();
+            gen.qNoise(data.data(), N, 0, qNoiseParams(t, qi, H));
+            qNoiseStats stats = gen.getStats();
+            int maxRejected = 0;
+            for (int k = 0; k < 22; k++)
+                if (stats.attempts[k] > 0)
+                    maxRejected = k;
+            std::cout << "retries\t" << t << "\t" << qi << "\t" << stats.retries[0] << "\t"
+                      << stats.retries[1] << "\t" << stats.resets << "\t"
+                      << double(stats.wastedDraws) / N << "\t" << maxRejected << std::endl;
+        }
+    }
+#endif
+
+    // Multi-path engine: the same number of samples spread over many paths
+    for (double qi : q) {
+        qNoiseMulti multi(paths, 1., qi, H);
+        multi.seedManual(12345678);
+        benchClock::time_point start = benchClock::now();
+        multi.qNoise(data.data(), N / paths);
+        record("multi", "qNoise", "qNoiseMulti", 1., qi, 1, N / paths * paths,
+               nsPerSample(start, N / paths * paths));
+    }
+
+    // Correlated channels: 64 paths mixed by the Cholesky factor of a
+    // correlation of 0.5 between every pair
+    const size_t channels = 64;
+    std::vector<double> correlation(channels * channels, 0.5);
+    for (size_t i = 0; i < channels; i++)
+        correlation[i * channels + i] = 1;
+    for (double qi : q) {
+        qNoiseMulti multi(channels, 1., qi, H);
+        multi.seedManual(12345678);
+        multi.setCorrelation(correlation);
+        benchClock::time_point start = benchClock::now();
+        multi.qNoise(data.data(), N / channels, LAYOUT_PLANAR);
+        record("channels", "qNoise", "qNoiseMulti", 1., qi, 1, N / channels * channels,
+               nsPerSample(start, N / channels * channels));
+    }
+
+    // Generator pool with 1 to all the threads
+    unsigned maxThreads = std::thread::hardware_concurrency();
+    if (maxThreads == 0)
+        maxThreads = 1;
+    std::vector<unsigned> threadCounts;
+    for (unsigned threads = 1; threads < maxThreads; threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(maxThreads);
+    for (unsigned threads : threadCounts) {
+        qNoisePool pool(12345678, threads);
+        benchClock::time_point start = benchClock::now();
+        pool.parallel_generate(data.data(), paths, N / paths, qNoiseParams(1., 1.2, H));
+        record("threads", "qNoise", "qNoisePool", 1., 1.2, threads, N / paths * paths,
+               nsPerSample(start, N / paths * paths));
+    }
+
+    // Output: generation plus writing to disk in every format
+    {
+        qNoiseParams p(1., 1.2, H);
+        const size_t chunk = 1 << 16;
+        const char *formatName[] = {"txt", "f64", "f32", "npy", "npy32"};
+        std::vector<char> fileBuffer(1 << 20);
+        for (int f = FORMAT_TXT; f <= FORMAT_NPY32; f++) {
+            benchClock::time_point start = benchClock::now();
+            std::ofstream file;
+            file.rdbuf()->pubsetbuf(fileBuffer.data(), fileBuffer.size());
+            file.open("bench_output.txt", std::ios::binary);
+            qNoiseWriter writer(file, qNoiseFormat(f));
+            writer.header(N);
+            double x = 0;
+            for (long int i = 0; i < N; i += chunk) {
+                size_t n = std::min<long int>(chunk, N - i);
+                x = gen.qNoise(data.data(), n, x, p);
+                writer.write(data.data(), n);
+            }
+            file.close();
+            record("output", "qNoise", std::string("ofstream-") + formatName[f], 1., 1.2, 1, N,
+                   nsPerSample(start, N));
+        }
+
+        benchClock::time_point start = benchClock::now();
+        qNoiseMap map;
+        if (map.open("bench_output.txt", N)) {
+            gen.qNoise(map.writableData(), N, 0, p);
+            map.close();
+            record("output", "qNoise", "mmap-f64", 1., 1.2, 1, N, nsPerSample(start, N));
+        }
+        remove("bench_output.txt");
+    }
+
+    // Real-time feed: cost of next() for the consumer
+    {
+        qNoiseFeed feed(qNoiseParams(1., 1.2, H));
+        feed.generator().setGaussBackend(qNoiseGen::GAUSS_ZIGGURAT);
+        feed.start();
+        double sum = 0;
+        benchClock::time_point start = benchClock::now();
+        for (long int i = 0; i < N; i++)
+            sum += feed.next();
+        double consumer = nsPerSample(start, N);
+        feed.stop();
+        record("feed", "qNoise", "qNoiseFeed-next", 1., 1.2, 2, N, consumer);
+        std::cout << "feed underruns: " << feed.underruns() << ", checksum: " << sum << std::endl;
+    }
+
+    if (csvName)
+        saveCSV(csvName);
+    if (jsonName)
+        saveJSON(jsonName);
+    return 0;
+}
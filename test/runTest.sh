@@ -129,3 +129,14 @@ echo "-----------------------------------------"
 ERROR=$(($ERROR+$?))
 cat 'qNoise_'"$tau"'_'"$H"'_'"$q"'_'"$N"'.txt'
 ERROR=$(($ERROR+$?))
+q=3.5
+echo "-----------------------------------------"
+echo "tau=$tau; H=$H; q=$q; N=$N"
+echo "-----------------------------------------"
+./test_qNoise $tau $H $q $N
+ERROR=$(($ERROR+$?))
+cat 'qNoise_'"$tau"'_'"$H"'_'"$q"'_'"$N"'.txt'
+ERROR=$(($ERROR+$?))
+# No stationary PDF for q>=3, the series must still be finite
+grep -qi nan 'qNoise_'"$tau"'_'"$H"'_'"$q"'_'"$N"'.txt'
+ERROR=$(($ERROR+1-$?))
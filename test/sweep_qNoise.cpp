@@ -0,0 +1,80 @@
+/*
+qNoise: A generator of non-Gaussian colored noise
+Copyright © 2021, Juan Ignacio Deza
+email: ignacio.deza@uwe.ac.uk
+
+Description
+qNoise is a non-gaussian colored random noise generator. It is a handy source of self-correlated noise for a great variety of applications. It depends on two parameters only: tau for controlling the autocorrelation, and q for controlling the statistics. This noise tends smoothly  for q = 1 to an  Ornstein-Uhlenbeck (colored gaussian) noise with autocorrelation tau. for q < 1 it is bounded noise and it is supra-Gaussian for q > 1.
+The noise is generated  via a stochastic differential equation using the Heun method (a second order Runge-Kutta type integration scheme) and it is implemented as a stand-alone library in c++.
+It Useful as input for numerical simulations, as a source of noise for controlling experiments using synthetic noise via micro-controllers and for a wide variety of applications.
+
+Requirements
+It is a stand-alone library with no dependencies other than the standard libraries.
+Due to it's use of some functions from the <random> library the library currently works on c++11 or higher only.
+This should be OK for most Macs and new Linux systems.
+In some older systems it is possible that you need to add `-std=gnu++11` to your compilation flags.
+
+Licence
+ This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <fstream>
+#include "../qNoiseSweep.h"
+
+/*
+ * Parameter sweep over the grid of the unit tests (tau, q and N). Each pair
+ * (tau, q) is generated once with the largest N on a pool of threads, the
+ * smaller N are read from its prefixes, and all the statistics are written to
+ * a single results file.
+ * Use: ./sweep_qNoise [--threads n] [--seed s] [--norm] [--out file]
+ */
+int main(int argc, char** argv) {
+    qNoiseSweepSpec spec;
+    unsigned threads = std::thread::hardware_concurrency();
+    const char *outName = "qNoise_sweep.txt";
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--threads") && i + 1 < argc)
+            threads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--seed") && i + 1 < argc)
+            spec.seed = strtoul(argv[++i], 0, 10);
+        else if (!strcmp(argv[i], "--norm"))
+            spec.norm = true;
+        else if (!strcmp(argv[i], "--out") && i + 1 < argc)
+            outName = argv[++i];
+        else {
+            std::cerr << "Use: " << argv[0] << " [--threads n] [--seed s] [--norm] [--out file]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    qNoiseSweep sweep(spec);
+    sweep.run(threads);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::ofstream file(outName);
+    if (!file) {
+        std::cerr << "Cannot open " << outName << std::endl;
+        return 1;
+    }
+    sweep.write(file);
+    std::cout << spec.tau.size() * spec.q.size() << " series of " << spec.N.back()
+              << " points on " << threads << " threads in " << seconds << " s, results in "
+              << outName << std::endl;
+    return 0;
+}
@@ -32,17 +32,86 @@ Licence
 #include <iostream>
 #include <cstdlib>
 #include "../qNoise.h"
+#include "../qNoiseIO.h"
 #include <sstream>
 #include <fstream>
+#include <vector>
+#include <algorithm>
+
+/*
+ * Generation through a memory mapping (format map). The file is grown to hold
+ * N more points, which are generated directly in the mapping. The last value
+ * and the state of the generator are saved in fileName.state, so running it
+ * again with the same file continues the same series.
+ */
+int generateMapped(qNoiseGen &gen, const std::string &fileName, double tau, double H, double q, long int N) {
+    qNoiseCheckpoint checkpoint;
+    std::string stateName = fileName + ".state";
+    long int start = 0;
+    double x;
+    if (checkpoint.load(stateName)) {
+        std::istringstream state(checkpoint.state);
+        if (checkpoint.tau != tau || checkpoint.q != q || checkpoint.H != H || !gen.loadState(state)) {
+            std::cerr << "Checkpoint " << stateName << " does not match the parameters" << std::endl;
+            return 1;
+        }
+        start = checkpoint.n; //Continue the series, no transient needed
+        x = checkpoint.eta;
+    } else {
+        x = gen.qNoiseStart(qNoiseParams(tau, q, H)); //Initial value from the stationary PDF, no transient needed for q<3
+    }
+    qNoiseMap map;
+    if (!map.open(fileName, start + N)) {
+        std::cerr << "Cannot map " << fileName << std::endl;
+        return 1;
+    }
+    qNoiseParams p(tau, q, H);
+    const long int chunk = 1 << 20;
+    for (long int i = 0; i < N; i += chunk)
+        x = gen.qNoise(map.writableData() + start + i, std::min(chunk, N - i), x, p);
+    map.close();
+    std::ostringstream state;
+    gen.saveState(state);
+    checkpoint.tau = tau;
+    checkpoint.q = q;
+    checkpoint.H = H;
+    checkpoint.n = start + N;
+    checkpoint.eta = x;
+    checkpoint.state = state.str();
+    if (!checkpoint.save(stateName)) {
+        std::cerr << "Cannot save " << stateName << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Generation of the N points written, in chunks of the
+ * precision of the samples: float for the formats f32 and npy32, so that they
+ * are generated in single precision end to end, double otherwise.
+ */
+template <class T>
+void generateSeries(qNoiseGen &gen, qNoiseWriter &writer, T x, double tau, double H, double q, long int N) {
+    qNoiseParams p(tau, q, H);
+    std::vector<T> buffer(1 << 16); //Points are generated in chunks
+    for (long int i = 0; i < N; i += buffer.size()) {
+        size_t n = std::min<long int>(buffer.size(), N - i);
+        x = gen.qNoise(buffer.data(), n, x, p);  //call to qNoise
+        writer.write(buffer.data(), n);   //Write to disk
+    }
+}
 
 /*
  * This program shows the functionality of the class qNoise main function
  * generating a file with a time series with the given parameters.
  * the program can be easily edited for other uses.
+ * Optionally the format can be chosen (txt by default, f64, f32, npy, npy32,
+ * map) and the output file, "-" sending the series to the standard output.
  */
 int main(int argc, char** argv) {
-    if (argc != 5) {
-        std::cerr << "Use: " << argv[0] << " tau H q N " << std::endl;
+    qNoiseFormat format = FORMAT_TXT;
+    if (argc < 5 || argc > 7 || (argc > 5 && !parseFormat(argv[5], format))) {
+        std::cerr << "Use: " << argv[0] << " tau H q N [txt|f64|f32|npy|npy32|map] [file|-]" << std::endl;
         return 1;
     }
     bool verbose = false;
@@ -51,23 +120,41 @@ int main(int argc, char** argv) {
     double tau = atof(argv[1]); //time constant
     double H = atof(argv[2]); //number of time steps per unit of time
     double q = atof(argv[3]); //parameter to switch statistics
-    int N = atoi(argv[4]); //Number of points to generate
-    double sqrt_H = sqrt(H); //defined for optimization purposes
+    long int N = atol(argv[4]); //Number of points to generate
     double x; //Value of the noise
-    double temp_time = 2 * tau / H; //transient time. It's a good idea to make it dependent of Tau
     std::stringstream fileName; //Create filename
-    fileName << "qNoise_" << tau << "_" << H << "_" << q << "_" << N << ".txt";
+    if (argc == 7)
+        fileName << argv[6];
+    else if (format == FORMAT_MAP) //Without N, as it can be extended
+        fileName << "qNoise_" << tau << "_" << H << "_" << q << "." << formatExtension(format);
+    else
+        fileName << "qNoise_" << tau << "_" << H << "_" << q << "_" << N << "." << formatExtension(format);
+    if (format == FORMAT_MAP)
+        return generateMapped(gen, fileName.str(), tau, H, q, N);
+    bool toStdout = (fileName.str() == "-");
+    std::vector<char> fileBuffer(1 << 20); //Large buffer, written in big blocks
     std::ofstream myfile;
-    myfile.open(fileName.str());
+    if (!toStdout) {
+        myfile.rdbuf()->pubsetbuf(fileBuffer.data(), fileBuffer.size());
+        myfile.open(fileName.str(), std::ios::binary);
+        if (!myfile) {
+            std::cerr << "Cannot open " << fileName.str() << std::endl;
+            return 1;
+        }
+    } else
+        std::ios::sync_with_stdio(false);
+    qNoiseWriter writer(toStdout ? std::cout : myfile, format);
+    writer.header(N);
     //gen.seedManual(12345678); //Manual seeding (for debugging etc..), comment for auto seeding
-    x = gen.gaussWN() / 100; //Initial value, can be anything. Better if it's around zero.
-     for (int i = 0; i < N + temp_time; i++) {
-        x = gen.qNoise(x, tau, q, H, sqrt_H);  //call to qNoise
-        if (i > temp_time)
-            myfile << x << std::endl;   //Write to disk after the transient.
-    }
-    myfile.close();
+    x = gen.qNoiseStart(qNoiseParams(tau, q, H)); //Initial value from the stationary PDF, so no transient is needed for q<3
+    if (format == FORMAT_F32 || format == FORMAT_NPY32)
+        generateSeries<float>(gen, writer, x, tau, H, q, N);
+    else
+        generateSeries<double>(gen, writer, x, tau, H, q, N);
+    if (toStdout)
+        std::cout.flush();
+    else
+        myfile.close();
     if (verbose) std::cout << "Saved in file: " << fileName.str() << std::endl;
     return 0;
 }
-
@@ -38,6 +38,22 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "qNoiseCache.h"
+#include "qNoiseFeed.h"
+#include "qNoiseFractional.h"
+#include "qNoiseMulti.h"
+#include "qNoiseOnline.h"
+#include "qNoisePool.h"
+#include "qNoiseSpectrum.h"
+#include "qNoiseSweep.h"
 
 const int bins = 50;
 double histComparison(std::vector<double> &value,
@@ -53,6 +69,7 @@ double test_qNoise(const std::vector<double> &data, double tau, double q,
                    double H, long int N, bool show);
 double test_qNoiseNorm(const std::vector<double> &data, double tau, double q,
                        double H, long int N, bool show);
+double effectiveSize(double tau, double H, long int N);
 
 double histComparison(std::vector<double> &value,
                       std::vector<double> &value_theory) {
@@ -62,7 +79,7 @@ double histComparison(std::vector<double> &value,
   for (int i = 0; i < value.size(); i++) {
     distance +=
         sqrt((value[i] - value_theory[i]) * (value[i] - value_theory[i]));
-    assert(!isnan(distance));
+    assert(!std::isnan(distance));
   }
   // Average of distance as a percentage of total size of the histogram
 
@@ -73,26 +90,85 @@ double histComparison(std::vector<double> &value,
 }
 
 /*
- * Generate a histogram from the data with a fixed number of bins the max and
- * min of the data are calculated.
+ * Run f(t, begin, end) on `threads` threads, each one over its share of
+ * [0, n).
  */
-void genHistogram(const std::vector<double> &data, std::vector<double> &key,
-                  std::vector<double> &value, long int N, int bins) {
-  double min = *std::min_element(data.begin(), data.end());
-  double max = *std::max_element(data.begin(), data.end());
+template <class F> static void runThreads(unsigned threads, long int n, F f) {
+  std::vector<std::thread> workers;
+  long int share = (n + threads - 1) / threads;
+  for (unsigned t = 0; t < threads; t++)
+    workers.push_back(std::thread(f, t, std::min(n, t * share),
+                                  std::min(n, (t + 1) * share)));
+  for (unsigned t = 0; t < threads; t++)
+    workers[t].join();
+}
 
-  for (double x = min; x < max; x += (max - min) / bins) {
-    key.push_back(x);
-    value.push_back(0);
+/*
+ * Minimum and maximum in a single pass, written so that it vectorizes.
+ */
+static void minMax(const double *x, long int n, double &min, double &max) {
+  double lo = x[0], hi = x[0];
+  for (long int i = 1; i < n; i++) {
+    lo = x[i] < lo ? x[i] : lo;
+    hi = x[i] > hi ? x[i] : hi;
   }
+  min = lo;
+  max = hi;
+}
 
-  for (int i = 0; i < N; i++) {
-    int x = int(round((data[i] - min) / (max - min) * bins));
-    assert(isnormal(x + 1));
-    value[x] += 1.0 / N / ((max - min) * bins);
+/*
+ * Add the points to the histogram in blocks: the indices of a block are
+ * computed first (vectorized, with the reciprocal of the bin width), then
+ * counted.
+ */
+static void binBlocks(const double *x, long int n, double min, double scale,
+                      std::vector<long int> &counts) {
+  const long int block = 1024;
+  int index[block];
+  for (long int start = 0; start < n; start += block) {
+    long int size = std::min(block, n - start);
+    for (long int i = 0; i < size; i++)
+      index[i] = int((x[start + i] - min) * scale + 0.5);
+    for (long int i = 0; i < size; i++)
+      counts[index[i]]++;
   }
+}
 
-  return;
+/*
+ * Generate a histogram from the first N points of the data with a fixed
+ * number of bins between their min and max. The key of each bin is its
+ * center, bins + 1 of them from min to max. Long series are split between
+ * the threads, each one with its own histogram, merged at the end.
+ */
+void genHistogram(const std::vector<double> &data, std::vector<double> &key,
+                  std::vector<double> &value, long int N, int bins) {
+  unsigned threads = 1;
+  if (N >= (1 << 20))
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  const double *x = data.data();
+
+  std::vector<double> mins(threads, x[0]), maxs(threads, x[0]);
+  runThreads(threads, N, [&](unsigned t, long int begin, long int end) {
+    if (end > begin)
+      minMax(x + begin, end - begin, mins[t], maxs[t]);
+  });
+  double min = *std::min_element(mins.begin(), mins.end());
+  double max = *std::max_element(maxs.begin(), maxs.end());
+
+  double scale = bins / (max - min);
+  std::vector<std::vector<long int> > counts(
+      threads, std::vector<long int>(bins + 1, 0));
+  runThreads(threads, N, [&](unsigned t, long int begin, long int end) {
+    binBlocks(x + begin, end - begin, min, scale, counts[t]);
+  });
+
+  for (int i = 0; i <= bins; i++) {
+    long int count = 0;
+    for (unsigned t = 0; t < threads; t++)
+      count += counts[t][i];
+    key.push_back(min + i * (max - min) / bins);
+    value.push_back(count * (1.0 / N / ((max - min) * bins)));
+  }
 }
 
 void calculatePDF(std::vector<double> &key, std::vector<double> &value_theory,
@@ -104,7 +180,7 @@ void calculatePDF(std::vector<double> &key, std::vector<double> &value_theory,
   if (q == 1) {
     for (int i = 0; i < key.size(); i++) {
       double v = exp(-tau * key[i] * key[i]);
-      assert(!isnan(v));
+      assert(!std::isnan(v));
       value_theory.push_back(v);
       total += v;
     }
@@ -113,7 +189,7 @@ void calculatePDF(std::vector<double> &key, std::vector<double> &value_theory,
     // cutoff
     for (int i = 0; i < key.size(); i++) {
       double v = pow((1 - (key[i] / w) * (key[i] / w)), (1 / (1 - q)));
-      if (isnan(v))
+      if (std::isnan(v))
         // Some bins fall outside the defined support
         v = 0;
       value_theory.push_back(v);
@@ -122,7 +198,7 @@ void calculatePDF(std::vector<double> &key, std::vector<double> &value_theory,
   } else if (q > 1) {
     for (int i = 0; i < key.size(); i++) {
       double v = pow((1 + tau * (q - 1) * key[i] * key[i]), (1 / (1 - q)));
-      assert(!isnan(v));
+      assert(!std::isnan(v));
       value_theory.push_back(v);
       total += v;
     }
@@ -192,6 +268,51 @@ double test_qNoiseNorm(const std::vector<double> &data, double tau, double q,
   return test_qNoise(data, tau, q, H, N, show);
 }
 
+/*
+ * n points of qNoise from eta with the header-only generator of qNoiseCore.h
+ * in the floating point type Real, seeded with seed, written to out.
+ */
+template <class Real, class Regime>
+static void coreSeries(const qNoiseParams &p, unsigned seed, double eta,
+                       double *out, long int n) {
+  qnoise::Generator<Real, std::mt19937, Regime> core(
+      qnoise::Params<Real>(p.tau, p.q, p.H), seed);
+  std::vector<Real> series(n);
+  core.generate(series.data(), n, Real(eta));
+  std::copy(series.begin(), series.end(), out);
+}
+
+/*
+ * Reference for qnoise::boundedRoot: the middle root of the cubic in closed
+ * form (trigonometric method), in long double.
+ */
+static long double trigRoot(long double b, long double etaCut,
+                            long double aH) {
+  long double c2 = etaCut * etaCut;
+  long double p = -c2 * (1 + aH) - b * b / 3;
+  long double q = -2 * b * b * b / 27 - b * c2 * (1 + aH) / 3 + b * c2;
+  long double r = std::sqrt(-p / 3);
+  long double arg = std::fmin(1.0L, std::fmax(-1.0L, -q / (2 * r * r * r)));
+  return b / 3 + 2 * r * std::cos(std::acos(arg) / 3 -
+                                  2.09439510239319549230842892218633526L);
+}
+
+/*
+ * Effective sample size of a series of N points with correlation time tau,
+ * the number of independent values it is worth: N H / (2 tau).
+ */
+double effectiveSize(double tau, double H, long int N) {
+  return N * H / (2 * tau);
+}
+
+/*
+ * Smallest effective sample size of the series whose PDF is compared with the
+ * usual limit of 10%. The distance of a correct series is about
+ * 50 / sqrt(Neff) % (2.5 times that at most), so shorter series could exceed
+ * it and are not tested.
+ */
+const double minEffectiveSize = 160;
+
 /* Main function for unit testing purposes only */
 int main() {
   long int NArray[] = {int(1e4),int(1e5),int(1e6),int(1e7)};
@@ -209,11 +330,11 @@ int main() {
   if (simple_example) {
     double t = 100, qi = .001;
     int N = int(1e8);
-    double old = gen.gaussWN();
+    double old = gen.qNoiseStationary(qNoiseParams::norm(t, qi, H));
     // First point
     for (int i = 0; i < N; i++) {
       double tmp = gen.qNoiseNorm(old, t, qi, H, sqrt_H);
-      assert(isnormal(tmp));
+      assert(std::isnormal(tmp));
       data[i] = tmp;
       old = tmp;
     }
@@ -240,15 +361,144 @@ int main() {
               << "\%, limit= " << limit << "\%, result:.................." << test << std::endl;
   }
 
+  // Gaussian White Noise from the Ziggurat backend
+  gen.setGaussBackend(qNoiseGen::GAUSS_ZIGGURAT);
+  for (long int N : NArray) {
+    gen.gaussWN(data.data(), N);
+
+    double x = test_gaussWN(data, N);
+    std::string test =
+        (x <= limit) ? "PASSED" : "FAILED";
+    std::cout << "Ziggurat Gaussian White Noise, N= " << N << ", difference= " << x
+              << "\%, limit= " << limit << "\%, result:.................." << test << std::endl;
+  }
+  gen.setGaussBackend(qNoiseGen::GAUSS_STD);
+
+  // Gaussian White Noise from the counter-based generator
+  qNoiseGenPhilox genPhilox;
+  for (long int N : NArray) {
+    genPhilox.gaussWN(data.data(), N);
+
+    double x = test_gaussWN(data, N);
+    std::string test =
+        (x <= limit) ? "PASSED" : "FAILED";
+    std::cout << "Philox Gaussian White Noise, N= " << N << ", difference= " << x
+              << "\%, limit= " << limit << "\%, result:.................." << test << std::endl;
+  }
+
+  // A window of qNoise regenerated from the position of the counter-based
+  // engine, saved with tell() or reached with discard(), is the same.
+  for (double qi : {0.5, 1.0, 1.2}) {
+    long int N = NArray[0];
+    qNoiseParams p(1, qi, H);
+    qNoiseGenPhilox window;
+    window.setBoundedScheme(qNoiseGenPhilox::BOUNDED_IMPLICIT);
+    window.seedManual(7654321);
+    std::vector<double> first(N), again(N);
+    uint64_t start = window.engine().tell();
+    double eta = window.qNoise(data.data(), N, 0.1, p);
+    uint64_t pos = window.engine().tell();
+    window.qNoise(first.data(), N, eta, p);
+    window.engine().seek(pos);
+    window.qNoise(again.data(), N, eta, p);
+    bool ok = first == again;
+    // Every step takes one Gaussian variate, a whole block of four words
+    window.engine().seek(start);
+    window.discard(N);
+    ok = ok && window.engine().tell() == pos;
+    window.qNoise(again.data(), N, eta, p);
+    ok = ok && first == again;
+    std::cout << "Philox window regenerated, N= " << N << ",q= " << qi
+              << ", result:.................." << (ok ? "PASSED" : "FAILED")
+              << std::endl;
+  }
+
+  // discard(N) skips the variates of N steps: the series that follows is the
+  // one after generating N points and dropping them, for every engine and
+  // backend.
+  for (double qi : {0.5, 1.0, 1.2}) {
+    long int N = NArray[0];
+    qNoiseParams p(1, qi, H);
+    std::vector<double> dropped(N), skipped(N);
+    bool ok = true;
+    for (qNoiseGen::gaussBackend backend :
+         {qNoiseGen::GAUSS_STD, qNoiseGen::GAUSS_ZIGGURAT}) {
+      qNoiseGen generated, discarded;
+      for (qNoiseGen *g : {&generated, &discarded}) {
+        g->setBoundedScheme(qNoiseGen::BOUNDED_IMPLICIT);
+        g->setGaussBackend(backend);
+        g->seedManual(24680);
+      }
+      generated.qNoise(dropped.data(), N, 0.1, p);
+      generated.qNoise(dropped.data(), N, 0.1, p);
+      discarded.discard(N);
+      discarded.qNoise(skipped.data(), N, 0.1, p);
+      ok = ok && dropped == skipped;
+    }
+    qNoiseGenPhilox generated, discarded;
+    for (qNoiseGenPhilox *g : {&generated, &discarded}) {
+      g->setBoundedScheme(qNoiseGenPhilox::BOUNDED_IMPLICIT);
+      g->seedManual(24680);
+    }
+    generated.qNoise(dropped.data(), N, 0.1, p);
+    generated.qNoise(dropped.data(), N, 0.1, p);
+    discarded.discard(N);
+    discarded.qNoise(skipped.data(), N, 0.1, p);
+    ok = ok && dropped == skipped;
+    std::cout << "Discard of N steps, N= " << N << ",q= " << qi
+              << ", result:.................." << (ok ? "PASSED" : "FAILED")
+              << std::endl;
+  }
+
+  // Independent draws from the stationary PDF of qNoise, which does not exist
+  // for q >= 3
+  assert(std::isnan(gen.qNoiseStationary(1, 3)) &&
+         std::isnan(gen.qNoiseStationary(1, 4)) &&
+         std::isfinite(gen.qNoiseStationary(1, 2.9)));
+
+  // For q >= 3 a series starts after a transient instead, and the series of
+  // qNoiseMulti and of the pool stay finite
+  {
+    qNoiseParams p(1, 3.5, H);
+    size_t paths = 4, n = NArray[0];
+    std::vector<double> out(paths * n);
+    bool ok = std::isfinite(gen.qNoiseStart(p));
+    qNoiseMulti multi(paths, p);
+    multi.stationaryState();
+    multi.qNoise(out.data(), n);
+    ok = ok && std::all_of(out.begin(), out.end(),
+                           [](double x) { return std::isfinite(x); });
+    qNoisePool pool(7654321, 2);
+    pool.parallel_generate_stationary(out.data(), paths, n, p);
+    ok = ok && std::all_of(out.begin(), out.end(),
+                           [](double x) { return std::isfinite(x); });
+    std::cout << "Start of a series, q= " << p.q
+              << ", result:.................." << (ok ? "PASSED" : "FAILED")
+              << std::endl;
+  }
+  for (long int N : NArray)
+    for (double t : tau)
+      for (double qi : q) {
+        for (int i = 0; i < N; i++)
+          data[i] = gen.qNoiseStationary(t, qi);
+
+        double x = test_qNoise(data, t, qi, H, N);
+        std::string test = (x <= limit) ? "PASSED"
+                                        : "FAILED";
+        std::cout << "Stationary Qnoise, N= " << N << ", tau= " << t << ",q= " << qi
+                  << ", difference= " << x << "\%, limit= " << limit
+                  << "\%, result:.................." << test << std::endl;
+      }
+
   // Ornstein - Uhlenbeck noise
   for (double t : tau) {
     for (long int N : NArray) {
 
-      double old = gen.gaussWN();
+      double old = gen.qNoiseStationary(t, 1);
       // First point
       for (int i = 0; i < N; i++) {
         double tmp = gen.orsUhl(old, t, H);
-        assert(isnormal(tmp));
+        assert(std::isnormal(tmp));
         data[i] = tmp;
         old = tmp;
       }
@@ -261,16 +511,122 @@ int main() {
     }
   }
 
+  // Online statistics of the Ornstein-Uhlenbeck noise, in two halves merged.
+  // Merging the halves gives the same moments and histogram as one pass, and
+  // the adaptive histogram the same bins as a fixed one over its range.
+  for (double t : tau) {
+    for (long int N : NArray) {
+      size_t stride = std::max(1L, lround(t / H / 8));
+      qNoiseMoments moments[2], whole;
+      qNoiseHistogram histogram[2], wholeHistogram;
+      qNoiseAutocorr autocorr[2] = {qNoiseAutocorr(16 * stride, stride),
+                                    qNoiseAutocorr(16 * stride, stride)};
+      double old = gen.qNoiseStationary(t, 1);
+      for (int half = 0; half < 2; half++) {
+        old = gen.orsUhl(data.data() + half * N / 2, N / 2, old, t, H);
+        moments[half].add(data.data() + half * N / 2, N / 2);
+        histogram[half].add(data.data() + half * N / 2, N / 2);
+        autocorr[half].add(data.data() + half * N / 2, N / 2);
+      }
+      whole.add(data.data(), N);
+      wholeHistogram.add(data.data(), N);
+      moments[0].merge(moments[1]);
+      histogram[0].merge(histogram[1]);
+      autocorr[0].merge(autocorr[1]);
+
+      qNoiseHistogram fixed(wholeHistogram.lower(), wholeHistogram.upper(),
+                            wholeHistogram.bins());
+      fixed.add(data.data(), N);
+      bool merged = histogram[0].lower() == wholeHistogram.lower() &&
+                    histogram[0].count() == N &&
+                    wholeHistogram.underflow() + wholeHistogram.overflow() == 0;
+      for (size_t i = 0; i < wholeHistogram.bins(); i++)
+        merged = merged && histogram[0].count(i) == wholeHistogram.count(i) &&
+                 fixed.count(i) == wholeHistogram.count(i);
+      merged = merged && moments[0].count() == whole.count() &&
+               fabs(moments[0].mean() - whole.mean()) <=
+                   1e-12 * sqrt(whole.variance()) &&
+               fabs(moments[0].variance() / whole.variance() - 1) <= 1e-12 &&
+               fabs(moments[0].skewness() - whole.skewness()) <= 1e-9 &&
+               fabs(moments[0].kurtosis() / whole.kurtosis() - 1) <= 1e-12;
+      std::cout << "Online statistics merged, N= " << N << ", tau= " << t
+                << ", result:.................."
+                << (merged ? "PASSED" : "FAILED") << std::endl;
+
+      // Relative difference with the variance 1/(2 tau) and with tau. The
+      // estimate of the variance has a relative error of sqrt(2 tau / (N H))
+      // and that of tau twice that; the limits are four times those errors.
+      // Series shorter than 1000 tau are not tested.
+      if (N * H < 1000 * t)
+        continue;
+      double error = 100 * sqrt(2 * t / (N * H));
+      double x = 100 * fabs(moments[0].variance() * 2 * t - 1);
+      double y = 100 * fabs(autocorr[0].tau(H) / t - 1);
+      std::string test = (x <= 4 * error && y <= 8 * error) ? "PASSED" : "FAILED";
+      std::cout << "Online statistics Ornstein-Uhlenbeck, N= " << N << ", tau= " << t
+                << ", variance difference= " << x << "\%, limit= " << 4 * error
+                << "\%, tau difference= " << y << "\%, limit= " << 8 * error
+                << "\%, result:.................." << test << std::endl;
+    }
+  }
+
+  // Parameter sweep on a small grid: the results do not depend on the number
+  // of threads, and the statistics of the smaller N, a prefix of the series,
+  // are those of a direct pass over that many points of the same stream.
+  {
+    qNoiseSweepSpec spec;
+    spec.tau = {0.1, 1.};
+    spec.q = {0.5, 1., 1.2};
+    spec.N = {10000, 100000};
+    spec.H = 0.01;
+    qNoiseSweep one(spec), many(spec);
+    one.run(1);
+    many.run(4);
+    const std::vector<qNoiseSweepResult> &a = one.results(), &b = many.results();
+    bool same = a.size() == b.size();
+    for (size_t i = 0; same && i < a.size(); i++)
+      same = a[i].N == b[i].N && a[i].mean == b[i].mean &&
+             a[i].variance == b[i].variance && a[i].kurtosis == b[i].kurtosis &&
+             a[i].tauEff == b[i].tauEff && a[i].distance == b[i].distance &&
+             a[i].outside == b[i].outside;
+    std::cout << "Sweep with 1 and 4 threads, configurations= " << a.size()
+              << ", result:.................." << (same ? "PASSED" : "FAILED")
+              << std::endl;
+
+    size_t nN = spec.N.size();
+    for (size_t k = 0; k < spec.tau.size() * spec.q.size(); k++) {
+      const qNoiseSweepResult &r = a[k * nN];
+      qNoiseParams p(r.tau, r.q, spec.H);
+      qNoiseGen direct;
+      direct.seedStream(spec.seed, k);
+      std::vector<double> series(r.N);
+      direct.qNoise(series.data(), r.N, direct.qNoiseStart(p), p);
+      qNoiseMoments moments;
+      moments.add(series.data(), r.N);
+      size_t stride = std::max(1L, lround(r.tau / spec.H / 8));
+      qNoiseAutocorr autocorr(16 * stride, stride);
+      autocorr.add(series.data(), r.N);
+      bool equal = moments.mean() == r.mean &&
+                   moments.variance() == r.variance &&
+                   moments.kurtosis() == r.kurtosis &&
+                   autocorr.tau(spec.H) == r.tauEff;
+      std::cout << "Sweep prefix against a direct pass, N= " << r.N
+                << ", tau= " << r.tau << ",q= " << r.q
+                << ", result:.................."
+                << (equal ? "PASSED" : "FAILED") << std::endl;
+    }
+  }
+
   // qNoise
 for (long int N : NArray) 
   for (double t : tau)
     for (double qi : q){
 
-        double old = gen.gaussWN();
+        double old = gen.qNoiseStationary(t, qi);
         // First point
         for (int i = 0; i < N; i++) {
           double tmp = gen.qNoise(old, t, qi, H, sqrt_H);
-          assert(isnormal(tmp));
+          assert(std::isnormal(tmp));
           data[i] = tmp;
           old = tmp;
         }
@@ -284,16 +640,224 @@ for (long int N : NArray)
                   
       }
 
+  // qNoise with the rejection-free scheme for q<1. Series below the minimum
+  // effective sample size are not tested.
+  gen.setBoundedScheme(qNoiseGen::BOUNDED_IMPLICIT);
+  for (long int N : NArray)
+    for (double t : tau)
+      for (double qi : q) {
+        if (qi >= 1 || effectiveSize(t, H, N) < minEffectiveSize)
+          continue;
+        double old = gen.qNoiseStationary(t, qi);
+        // First point
+        gen.qNoise(data.data(), N, old, qNoiseParams(t, qi, H));
+
+        double x = test_qNoise(data, t, qi, H, N);
+        std::string test = (x <= limit) ? "PASSED"
+                                        : "FAILED";
+        std::cout << "Implicit bounded Qnoise, N= " << N << ", tau= " << t << ",q= " << qi
+                  << ", difference= " << x << "\%, limit= " << limit
+                  << "\%, result:.................." << test << std::endl;
+      }
+  gen.setBoundedScheme(qNoiseGen::BOUNDED_RETRY);
+
+  // Root of the implicit step by Halley iterations against the closed form,
+  // for b across the support and beyond it.
+  {
+    double worst = 0;
+    for (double t : {0.01, 0.1, 1., 10., 100.})
+      for (double qi : {0.1, 0.5, 0.9})
+        for (double h : {1e-4, H, 0.05}) {
+          qNoiseParams p(t, qi, h);
+          for (int i = -3000; i <= 3000; i++) {
+            double b = i * p.etaCut / 1000;
+            double x = qnoise::boundedRoot(b, p.etaCut, p.driftH / 2);
+            long double y = trigRoot(b, p.etaCut, p.driftH / 2);
+            worst = std::max(worst, double(std::fabs(x - y) / p.etaCut));
+          }
+        }
+    std::cout << "Root of the implicit step, difference= " << worst
+              << " etaCut, limit= 1e-12 etaCut, result:.................."
+              << (worst <= 1e-12 ? "PASSED" : "FAILED") << std::endl;
+  }
+
+  // qNoise generated in float32. Series below the minimum effective sample
+  // size are not tested.
+  {
+    std::vector<float> single(NArray[3]);
+    for (long int N : NArray)
+      for (double t : tau)
+        for (double qi : q) {
+          if (effectiveSize(t, H, N) < minEffectiveSize)
+            continue;
+          qNoiseParams p(t, qi, H);
+          float old = gen.qNoiseStationary(p);
+          gen.qNoise(single.data(), N, old, p);
+          for (int i = 0; i < N; i++) {
+            assert(std::isfinite(single[i]));
+            assert(qi >= 1 || fabs(single[i]) < float(p.etaCut));
+            data[i] = single[i];
+          }
+
+          double x = test_qNoise(data, t, qi, H, N);
+          std::string test = (x <= limit) ? "PASSED"
+                                          : "FAILED";
+          std::cout << "Float32 Qnoise, N= " << N << ", tau= " << t << ",q= " << qi
+                    << ", difference= " << x << "\%, limit= " << limit
+                    << "\%, result:.................." << test << std::endl;
+        }
+  }
+
+#ifdef QNOISE_STATS
+  // Counters of the steps: every step is counted once in attempts and the
+  // rejected attempts add up to the retries, with the single sample and batch
+  // versions (with and without qNoiseParams), in float and with qNoiseMulti,
+  // for every kernel. The first case goes through every phase
+  // of the retries.
+  {
+    long int N = NArray[1];
+    std::vector<float> single(N);
+    qNoiseMulti multi(1, 1, 1, H);
+    struct {
+      double t, q, h;
+      qNoiseGen::boundedScheme scheme;
+    } cases[] = {{0.1, 0.1, 0.05, qNoiseGen::BOUNDED_RETRY},
+                 {1, 0.5, H, qNoiseGen::BOUNDED_IMPLICIT},
+                 {1, 1, H, qNoiseGen::BOUNDED_RETRY},
+                 {1, 1.2, H, qNoiseGen::BOUNDED_RETRY}};
+    for (auto c : cases) {
+      qNoiseParams p(c.t, c.q, c.h);
+      gen.setBoundedScheme(c.scheme);
+      qNoiseStats stats[6];
+      gen.resetStats();
+      double eta = 0;
+      for (long int i = 0; i < N; i++)
+        eta = gen.qNoise(eta, c.t, c.q, c.h);
+      stats[0] = gen.getStats();
+      gen.resetStats();
+      eta = 0;
+      for (long int i = 0; i < N; i++)
+        eta = gen.qNoise(eta, p);
+      stats[1] = gen.getStats();
+      gen.resetStats();
+      gen.qNoise(data.data(), N, 0, p);
+      stats[2] = gen.getStats();
+      gen.resetStats();
+      gen.qNoise(data.data(), N, 0, c.t, c.q, c.h);
+      stats[3] = gen.getStats();
+      gen.resetStats();
+      gen.qNoise(single.data(), N, 0, p);
+      stats[4] = gen.getStats();
+      multi = qNoiseMulti(1, p);
+      multi.setBoundedScheme(c.scheme);
+      multi.qNoise(data.data(), N);
+      stats[5] = multi.getStats();
+      bool ok = true;
+      for (const qNoiseStats &st : stats) {
+        unsigned long long steps = 0, rejected = 0;
+        for (int k = 0; k < 22; k++) {
+          steps += st.attempts[k];
+          rejected += k * st.attempts[k];
+        }
+        ok = ok && steps == (unsigned long long)N &&
+             rejected == st.retries[0] + st.retries[1] + st.resets &&
+             st.wastedDraws == st.retries[0] + 2 * st.retries[1] + st.resets;
+      }
+      std::cout << "Counters of the steps, N= " << N << ", tau= " << c.t
+                << ",q= " << c.q << ", H= " << c.h
+                << ", resets= " << stats[2].resets
+                << ", result:.................." << (ok ? "PASSED" : "FAILED")
+                << std::endl;
+    }
+    gen.setBoundedScheme(qNoiseGen::BOUNDED_RETRY);
+  }
+#endif
+
+  // Header-only generator of qNoiseCore.h, for each regime and tau: in double
+  // it gives the same series as qNoiseGen with the same seed, and in float the
+  // same variance (within four times the error of the difference of two
+  // estimates, sqrt(2 / Neff)) and the PDF of qNoise. The last two are not
+  // tested below the minimum effective sample size.
+  {
+    long int N = NArray[3];
+    std::vector<double> direct(N);
+    gen.setBoundedScheme(qNoiseGen::BOUNDED_IMPLICIT);
+    for (double t : tau)
+      for (double qi : {0.5, 1.0, 1.2}) {
+        qNoiseParams p(t, qi, H);
+        double start = gen.qNoiseStationary(p);
+        gen.seedManual(7654321);
+        gen.qNoise(direct.data(), N, start, p);
+        if (qi < 1) {
+          coreSeries<double, qnoise::Bounded>(p, 7654321, start, data.data(), N);
+        } else if (qi == 1) {
+          coreSeries<double, qnoise::Gaussian>(p, 7654321, start, data.data(), N);
+        } else {
+          coreSeries<double, qnoise::Unbounded>(p, 7654321, start, data.data(), N);
+        }
+        bool same = std::equal(direct.begin(), direct.end(), data.begin());
+        if (qi < 1) {
+          coreSeries<float, qnoise::Bounded>(p, 1234567, start, data.data(), N);
+        } else if (qi == 1) {
+          coreSeries<float, qnoise::Gaussian>(p, 1234567, start, data.data(), N);
+        } else {
+          coreSeries<float, qnoise::Unbounded>(p, 1234567, start, data.data(), N);
+        }
+        qNoiseMoments reference, core;
+        reference.add(direct.data(), N);
+        core.add(data.data(), N);
+        double x = 100 * fabs(core.variance() / reference.variance() - 1);
+        double limitVar = 400 * sqrt(2 / effectiveSize(t, H, N));
+        double y = test_qNoise(data, t, qi, H, N);
+        bool tested = effectiveSize(t, H, N) >= minEffectiveSize;
+        std::string test =
+            (same && (!tested || (x <= limitVar && y <= limit))) ? "PASSED"
+                                                                  : "FAILED";
+        std::cout << "Header-only core Qnoise, N= " << N << ", tau= " << t
+                  << ",q= " << qi << ", same as qNoiseGen in double: "
+                  << (same ? "yes" : "no") << ", float variance difference= " << x
+                  << "\%, limit= " << limitVar << "\%, difference= " << y
+                  << "\%, limit= " << limit << (tested ? "\%" : "\% (not tested)")
+                  << ", result:.................." << test << std::endl;
+      }
+    gen.setBoundedScheme(qNoiseGen::BOUNDED_RETRY);
+  }
+
+  // qNoise after a linear ramp of q from 1, compared once stationary. Series
+  // below the minimum effective sample size are not tested.
+  {
+    assert(qNoiseSchedule(SCHEDULE_LINEAR, 0).resolution == 1);
+    std::vector<double> ramp(2 * NArray[2]);
+    for (long int N : NArray)
+      for (double t : tau)
+        for (double qi : q) {
+          if (N > NArray[2] || effectiveSize(t, H, N) < minEffectiveSize)
+            continue;
+          qNoiseSchedule s(SCHEDULE_LINEAR);
+          s.add(0, t, 1, H);
+          s.add(N, t, qi, H);
+          gen.qNoise(ramp.data(), 2 * N, gen.qNoiseStationary(t, 1), s);
+          std::copy(ramp.begin() + N, ramp.begin() + 2 * N, data.begin());
+
+          double x = test_qNoise(data, t, qi, H, N);
+          std::string test = (x <= limit) ? "PASSED"
+                                          : "FAILED";
+          std::cout << "Scheduled Qnoise, N= " << N << ", tau= " << t << ",q= " << qi
+                    << ", difference= " << x << "\%, limit= " << limit
+                    << "\%, result:.................." << test << std::endl;
+        }
+  }
+
   // Normalized qNoise
   for (double t : tau)
     for (double qi : q)
       for (long int N : NArray) {
 
-        double old = gen.gaussWN();
+        double old = gen.qNoiseStationary(qNoiseParams::norm(t, qi, H));
         // First point
         for (int i = 0; i < N; i++) {
           double tmp = gen.qNoiseNorm(old, t, qi, H, sqrt_H);
-          assert(isnormal(tmp));
+          assert(std::isnormal(tmp));
           data[i] = tmp;
           old = tmp;
         }
@@ -306,5 +870,403 @@ for (long int N : NArray)
                   << "\%, result:.................." << test << std::endl;
       }
 
+  // Independent paths advanced in lockstep, all of them compared at once.
+  // Series below the minimum effective sample size are not tested.
+  {
+    const size_t paths = 16;
+    for (long int N : NArray)
+      for (double t : tau)
+        for (double qi : q) {
+          if (effectiveSize(t, H, N) < minEffectiveSize)
+            continue;
+          qNoiseMulti multi(paths, t, qi, H);
+          multi.stationaryState();
+          multi.qNoise(data.data(), N / paths);
+
+          double x = test_qNoise(data, t, qi, H, N);
+          std::string test = (x <= limit) ? "PASSED" : "FAILED";
+          std::cout << "Multi-path Qnoise, N= " << N << ", tau= " << t
+                    << ",q= " << qi << ", difference= " << x
+                    << "\%, limit= " << limit
+                    << "\%, result:.................." << test << std::endl;
+        }
+  }
+
+  // A single path of qNoiseMulti is the series of qNoise with the same seed
+  // and backend, bit for bit, with both schemes for q<1
+  struct {
+    double q;
+    qNoiseGen::boundedScheme scheme;
+  } pathCases[] = {{0.5, qNoiseGen::BOUNDED_RETRY},
+                   {0.5, qNoiseGen::BOUNDED_IMPLICIT},
+                   {1.0, qNoiseGen::BOUNDED_RETRY},
+                   {1.2, qNoiseGen::BOUNDED_RETRY}};
+  for (double t : tau)
+    for (auto c : pathCases) {
+      long int N = NArray[1];
+      double qi = c.q;
+      qNoiseParams p(t, qi, H);
+      qNoiseMulti multi(1, p);
+      multi.setBoundedScheme(c.scheme);
+      multi.seedManual(7654321);
+      multi.qNoise(data.data(), N);
+      qNoiseGen single;
+      single.setGaussBackend(qNoiseGen::GAUSS_ZIGGURAT);
+      single.setBoundedScheme(c.scheme);
+      single.seedManual(7654321);
+      std::vector<double> direct(N);
+      double eta = 0;
+      for (long int i = 0; i < N; i++)
+        eta = single.qNoise(&direct[i], 1, eta, p);
+      bool same = std::equal(direct.begin(), direct.end(), data.begin());
+      std::cout << "Single path of qNoiseMulti, N= " << N << ", tau= " << t
+                << ",q= " << qi
+                << (c.scheme == qNoiseGen::BOUNDED_IMPLICIT ? ", implicit" : "")
+                << ", result:.................."
+                << (same ? "PASSED" : "FAILED") << std::endl;
+    }
+
+  // Channels with a correlation of 0.5 between every pair: the PDF of the
+  // first channel, and for q=1 the correlation between the first two. They
+  // are generated in chunks, keeping those two channels. Series below the
+  // minimum effective sample size are not tested.
+  {
+    const size_t channels = 8;
+    long int N = NArray[3], chunk = N / 16;
+    std::vector<double> correlation(channels * channels, 0.5);
+    for (size_t i = 0; i < channels; i++)
+      correlation[i * channels + i] = 1;
+    std::vector<double> planar(channels * chunk), second(N);
+    for (double t : tau)
+      for (double qi : q) {
+        if (effectiveSize(t, H, N) < minEffectiveSize)
+          continue;
+        qNoiseMulti multi(channels, t, qi, H);
+        bool ok = multi.setCorrelation(correlation);
+        assert(ok);
+        multi.stationaryState();
+        for (long int done = 0; done < N; done += chunk) {
+          multi.qNoise(planar.data(), chunk, LAYOUT_PLANAR);
+          std::copy(planar.begin(), planar.begin() + chunk,
+                    data.begin() + done);
+          std::copy(planar.begin() + chunk, planar.begin() + 2 * chunk,
+                    second.begin() + done);
+        }
+        double x = test_qNoise(data, t, qi, H, N);
+        std::string test = (x <= limit) ? "PASSED" : "FAILED";
+        std::cout << "Correlated channels Qnoise, N= " << N << ", tau= " << t
+                  << ",q= " << qi << ", difference= " << x
+                  << "\%, limit= " << limit
+                  << "\%, result:.................." << test << std::endl;
+        if (qi != 1)
+          continue;
+        qNoiseMoments a, b;
+        a.add(data.data(), N);
+        b.add(second.data(), N);
+        double cov = 0;
+        for (long int i = 0; i < N; i++)
+          cov += (data[i] - a.mean()) * (second[i] - b.mean());
+        double rho = cov / N / sqrt(a.variance() * b.variance());
+        // Error of the estimate about 1 / sqrt(Neff)
+        double limitRho = std::max(0.02, 3 / sqrt(effectiveSize(t, H, N)));
+        test = (fabs(rho - 0.5) <= limitRho) ? "PASSED" : "FAILED";
+        std::cout << "Correlated channels Ornstein-Uhlenbeck, N= " << N
+                  << ", tau= " << t << ", correlation= " << rho
+                  << ", expected= 0.5, limit= " << limitRho
+                  << ", result:.................." << test << std::endl;
+      }
+
+    // A rejected matrix leaves the paths independent, whatever correlation
+    // they had before: the series is the one of paths never correlated.
+    long int M = NArray[2];
+    std::vector<double> notPositive(correlation), rejected(channels * M),
+        independent(channels * M);
+    notPositive[1] = notPositive[channels] = 2;
+    qNoiseMulti before(channels, 1, 1, H), never(channels, 1, 1, H);
+    before.seedManual(1234);
+    never.seedManual(1234);
+    bool accepted = before.setCorrelation(correlation);
+    bool refused = !before.setCorrelation(notPositive) &&
+                   !before.setCorrelation(std::vector<double>(channels, 1));
+    before.qNoise(rejected.data(), M, LAYOUT_PLANAR);
+    never.qNoise(independent.data(), M, LAYOUT_PLANAR);
+    bool same = accepted && refused && rejected == independent;
+    std::cout << "Rejected correlation of qNoiseMulti, N= " << M
+              << ", result:.................." << (same ? "PASSED" : "FAILED")
+              << std::endl;
+  }
+
+  // Long-memory noise with the PDF of qNoise (Hurst exponent 0.75). The mean
+  // of N points varies as N^(2h-2), so the effective sample size is
+  // N^(2-2h) = sqrt(N) and the distance about 33 / sqrt(Neff) % (3.5 times
+  // that at most). Series below the minimum effective sample size are not
+  // tested.
+  for (long int N : NArray)
+    for (double t : tau)
+      for (double qi : q) {
+        if (pow(N, 2 - 2 * 0.75) < minEffectiveSize)
+          continue;
+        qNoiseFractional fractional(0.75, t, qi, 1 << 16);
+        fractional.generate(data.data(), N);
+
+        double x = test_qNoise(data, t, qi, H, N);
+        std::string test = (x <= limit) ? "PASSED"
+                                        : "FAILED";
+        std::cout << "Fractional Qnoise, N= " << N << ", tau= " << t << ",q= " << qi
+                  << ", difference= " << x << "\%, limit= " << limit
+                  << "\%, result:.................." << test << std::endl;
+      }
+
+  // For q>=3 there is no stationary PDF: the fractional noise is not valid and
+  // its values are NaN, while q just below 3 is still finite.
+  {
+    std::vector<double> values(1 << 10);
+    bool rejected = true;
+    for (double qi : {3.0, 3.5}) {
+      qNoiseFractional fractional(0.75, 1, qi, 1 << 10);
+      fractional.generate(values.data(), values.size());
+      rejected = rejected && !fractional.valid() &&
+                 std::isnan(qNoiseMarginal::upperQuantile(0.1, 1, qi)) &&
+                 std::all_of(values.begin(), values.end(),
+                             [](double x) { return std::isnan(x); });
+    }
+    qNoiseFractional finite(0.75, 1, 2.9, 1 << 10);
+    finite.generate(values.data(), values.size());
+    rejected = rejected && finite.valid() &&
+               std::all_of(values.begin(), values.end(),
+                           [](double x) { return std::isfinite(x); });
+    std::cout << "Fractional Qnoise, q>= 3 rejected, result:.................."
+              << (rejected ? "PASSED" : "FAILED") << std::endl;
+  }
+
+  // Autocorrelation of the fractional Gaussian noise, estimated over segments
+  // inside the blocks. Removing the mean of a segment of n points lowers it
+  // by about the variance of that mean, n^(2h-2), so the estimate is compared
+  // with (rho(k) - v) / (1 - v), rho(k) = 0.5 (|k+1|^2h - 2|k|^2h + |k-1|^2h).
+  {
+    long int N = NArray[3];
+    double hurst = 0.75, limitRho = 0.005;
+    size_t segment = 1 << 14;
+    qNoiseFractional fractional(hurst, 1, 1, 1 << 16);
+    fractional.gaussian(data.data(), N);
+    qNoiseSpectrum spectrum(1, segment);
+    spectrum.add(data.data(), N);
+    double v = pow(double(segment), 2 * hurst - 2), x = 0;
+    for (int k = 1; k <= 32; k++) {
+      double rho = 0.5 * (pow(k + 1, 2 * hurst) - 2 * pow(k, 2 * hurst) +
+                          pow(k - 1, 2 * hurst));
+      x = std::max(x, fabs(spectrum.acf(k) - (rho - v) / (1 - v)));
+    }
+    std::string test = (x <= limitRho) ? "PASSED" : "FAILED";
+    std::cout << "Fractional Gaussian noise autocorrelation, N= " << N
+              << ", Hurst= " << hurst << ", lags 1 to 32, difference= " << x
+              << ", limit= " << limitRho
+              << ", result:.................." << test << std::endl;
+  }
+
+  // Correlation time of normalized qNoise, which should be tau, fitted to
+  // the autocorrelation over segments of about 512 tau (so that the removal
+  // of their mean does not shorten it) and to the spectrum over segments of
+  // about 128 tau, averaged to about 64 points per tau. Both fits scatter by
+  // about 2.5 / sqrt(Neff), with Neff the effective sample size, so the
+  // limit is 4 times that, 10 / sqrt(Neff), 10 to 11% for the series of
+  // 16384 tau or more used (Neff of 8192 or more). tau = 100 would take 1.6e9 points and is
+  // not tested; the fit only depends on H / tau, the finest there. Neither
+  // are q < 0.3 and q = 1.3, where the normalization of tau, only first
+  // order in q - 1, is 10 to 15% off and the fourth moment diverges close
+  // to q = 7/5.
+  {
+    std::vector<double> chunk(1 << 16);
+    for (double t : tau)
+      for (double qi : q) {
+        size_t decimation = std::max(1L, lround(t / H / 64));
+        size_t segmentACF = 1 << 15, segmentPSD = 1 << 13;
+        long int N = 32 * segmentACF * decimation;
+        if (N > 20 * NArray[3] || qi < 0.3 || qi > 1.2)
+          continue;
+        qNoiseSpectrum correlation(H, segmentACF, decimation),
+            spectrum(H, segmentPSD, decimation);
+        qNoiseParams p = qNoiseParams::norm(t, qi, H);
+        double old = gen.qNoiseStationary(p);
+        for (long int done = 0; done < N; done += chunk.size()) {
+          size_t n = std::min(long(chunk.size()), N - done);
+          old = gen.qNoise(chunk.data(), n, old, p);
+          correlation.add(chunk.data(), n);
+          spectrum.add(chunk.data(), n);
+        }
+
+        double tauACF = correlation.tauACF(), tauPSD = spectrum.tauPSD();
+        double x = 100 * std::max(fabs(tauACF / t - 1), fabs(tauPSD / t - 1));
+        double limitN = 1000 / sqrt(effectiveSize(t, H, N));
+        std::string test = (x <= limitN) ? "PASSED" : "FAILED";
+        std::cout << "Correlation time Normalized Qnoise, N= " << N << ", tau= " << t
+                  << ",q= " << qi << ", tauACF= " << tauACF << ", tauPSD= " << tauPSD
+                  << ", difference= " << x << "\%, limit= " << limitN
+                  << "\%, result:.................." << test << std::endl;
+      }
+  }
+
+  // Pool of threads: the same output for any number of threads, and path j
+  // the same as a generator seeded with stream j of the master seed.
+  {
+    qNoiseParams p(1, 0.7, H);
+    size_t paths = 6, n = NArray[0];
+    unsigned threads[] = {1, 3, 5};
+    std::vector<double> first, out(paths * n), path(n);
+    bool ok = true;
+    for (unsigned w : threads) {
+      qNoisePool pool(7654321, w);
+      pool.parallel_generate_stationary(out.data(), paths, n, p);
+      if (first.empty())
+        first = out;
+      ok = ok && out == first;
+    }
+    qNoiseGen single;
+    for (size_t j = 0; j < paths; j++) {
+      single.seedStream(7654321, j);
+      single.qNoise(path.data(), n, single.qNoiseStationary(p), p);
+      ok = ok && std::equal(path.begin(), path.end(), first.begin() + j * n);
+    }
+    qNoisePool pool(7654321, 3);
+    pool.parallel_generate(out.data(), paths, n, p, 0.1);
+    for (size_t j = 0; j < paths; j++) {
+      single.seedStream(7654321, j);
+      single.qNoise(path.data(), n, 0.1, p);
+      ok = ok && std::equal(path.begin(), path.end(), out.begin() + j * n);
+    }
+    std::cout << "Pool of threads, paths= " << paths << ", N= " << n
+              << ", result:.................." << (ok ? "PASSED" : "FAILED")
+              << std::endl;
+  }
+
+  // Real-time feed: the blocks come in the order they were generated, the
+  // depth is what the ring holds, and the consumer gets an underrun when the
+  // ring is empty and the producer has stopped.
+  {
+    qNoiseParams p(1, 0.7, H);
+    const size_t blockSize = 64, blocks = 4;
+    long int N = 20 * blockSize;
+    qNoiseGen direct;
+    direct.seedManual(7654321);
+    double eta = 0.1;
+    for (long int i = 0; i < N; i += blockSize)
+      eta = direct.qNoise(data.data() + i, blockSize, eta, p);
+
+    qNoiseFeed feed(p, blockSize, blocks);
+    feed.generator().seedManual(7654321);
+    feed.start(0.1);
+    bool ordered = true;
+    for (long int i = 0; i < N; i++)
+      ordered = ordered && feed.next() == data[i];
+    feed.stop();
+
+    // Once the ring is full it holds every block but what has been read
+    qNoiseFeed ring(p, blockSize, blocks);
+    ring.start();
+    size_t full = blockSize * blocks;
+    while (ring.depth() < full)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    double x;
+    for (size_t i = 0; i < blockSize / 2; i++)
+      ring.tryNext(x);
+    bool depth = ring.depth() == full - blockSize / 2;
+
+    ring.stop();
+    ring.resetUnderruns();
+    size_t left = 0;
+    while (ring.tryNext(x))
+      left++;
+    bool underruns = left == full - blockSize / 2 && ring.underruns() == 1 &&
+                     std::isnan(ring.next()) && ring.underruns() == 2;
+    qNoiseFeed idle(p, blockSize, blocks);
+    underruns = underruns && std::isnan(idle.next()) && idle.underruns() == 1;
+    std::cout << "Real-time feed, blocks= " << blocks
+              << ", block size= " << blockSize
+              << ", order: " << (ordered ? "PASSED" : "FAILED")
+              << ", depth: " << (depth ? "PASSED" : "FAILED")
+              << ", underruns: " << (underruns ? "PASSED" : "FAILED")
+              << ", result:.................."
+              << (ordered && depth && underruns ? "PASSED" : "FAILED")
+              << std::endl;
+  }
+
+  // A mapped file is only grown: opening it again for fewer samples keeps the
+  // rest of the series.
+  {
+    long int N = NArray[1];
+    const char *name = "qNoise_map_test.f64";
+    qNoiseMap map;
+    bool ok = map.open(name, 2 * N);
+    if (ok)
+      gen.gaussWN(map.writableData(), 2 * N);
+    std::vector<double> written(map.data(), map.data() + map.size());
+    ok = ok && map.open(name, N) && map.size() == size_t(N) &&
+         map.openRead(name, 2 * N) &&
+         std::equal(written.begin(), written.end(), map.data());
+    map.close();
+    std::remove(name);
+    std::cout << "Mapped file reopened shorter, N= " << N
+              << ", result:.................." << (ok ? "PASSED" : "FAILED")
+              << std::endl;
+  }
+
+  // On-disk cache: a series, a prefix of it and an extension are the same as
+  // generated directly, and timer-seeded generators are not cached. With
+  // room for four series and a half, the eviction keeps the four most
+  // recently used.
+  {
+    qNoiseCache cache("qNoise_cache_test", 9 * NArray[1] * sizeof(double) / 2);
+    qNoiseParams p(1, 0.7, H);
+    long int N = NArray[1];
+    std::vector<double> direct(2 * N);
+    qNoiseGen seeded;
+    seeded.seedManual(1234567);
+    seeded.qNoise(direct.data(), 2 * N, seeded.qNoiseStationary(p), p);
+    seeded.seedManual(1234567);
+    qNoiseMap full, prefix, longer;
+    bool ok = cache.get(seeded, p, N, full) &&
+              cache.get(seeded, p, N / 2, prefix) &&
+              cache.get(seeded, p, 2 * N, longer) &&
+              std::equal(full.data(), full.data() + N, direct.begin()) &&
+              std::equal(prefix.data(), prefix.data() + N / 2,
+                         direct.begin()) &&
+              std::equal(longer.data(), longer.data() + 2 * N,
+                         direct.begin());
+    qNoiseGen timer;
+    qNoiseMap none;
+    ok = ok && !cache.get(timer, p, N, none);
+    // A stream with the std backend does not depend on earlier draws
+    qNoiseGen used, fresh;
+    used.gaussWN(direct.data(), N);
+    used.seedStream(42, 3);
+    used.setGaussBackend(qNoiseGen::GAUSS_STD);
+    used.qNoise(direct.data(), N, used.qNoiseStationary(p), p);
+    fresh.seedStream(42, 3);
+    fresh.setGaussBackend(qNoiseGen::GAUSS_STD);
+    qNoiseMap stream;
+    ok = ok && cache.get(fresh, p, N, stream) &&
+         std::equal(stream.data(), stream.data() + N, direct.begin());
+    // Other seeds fill the cache, which keeps the most recent series
+    for (unsigned k = 0; k < 8; k++) {
+      seeded.seedManual(k);
+      qNoiseMap other;
+      ok = ok && cache.get(seeded, p, N, other);
+    }
+    bool evicted = true;
+    for (unsigned k = 0; k < 8; k++) {
+      seeded.seedManual(k);
+      evicted = evicted && cache.contains(seeded, p, N) == (k >= 4);
+    }
+    seeded.seedManual(1234567);
+    evicted = evicted && !cache.contains(seeded, p, N);
+    cache.clear();
+    seeded.seedManual(7);
+    evicted = evicted && !cache.contains(seeded, p, N);
+    std::cout << "Cache of series, N= " << N
+              << ", eviction: " << (evicted ? "PASSED" : "FAILED")
+              << ", result:.................."
+              << (ok && evicted ? "PASSED" : "FAILED") << std::endl;
+  }
+
   return 0;
 }
\ No newline at end of file